@@ -25,6 +25,18 @@ bool is_lucky(float probability) {
   return bernoullu_distribution_var(rng);
 }
 
+// number of failed trials before the next success, so sparse passes can jump
+// straight to the next chosen vertex instead of rolling for every vertex
+int get_geometric_skip(float probability) {
+  assert(probability - FLOAT_COMPARISON_EPS > 0 &&
+         probability - FLOAT_COMPARISON_EPS < 1 &&
+         "given probability is incorrect");
+  // seeded once: a skip is a single draw, not a fresh engine per draw
+  static std::mt19937 rng{std::knuth_b{}()};
+  std::geometric_distribution<int> geometric_distribution_var(probability);
+  return geometric_distribution_var(rng);
+}
+
 void generate_vertices(Graph& graph, int depth, int new_vertices_num) {
   graph.add_vertex();
   for (int current_depth = 0;
@@ -45,10 +57,14 @@ void generate_vertices(Graph& graph, int depth, int new_vertices_num) {
 }
 
 void generate_green_edges(Graph& graph) {
-  for (const auto& [vertex_id, vertex] : graph.vertices()) {
-    if (is_lucky(GREEN_EDGE_PROB)) {
-      graph.add_edge(vertex_id, vertex_id, EdgeColor::Green);
-    }
+  const int vertices_count = graph.vertices().size();
+  auto it = graph.vertices().begin();
+  int it_index = 0;
+  for (int index = get_geometric_skip(GREEN_EDGE_PROB); index < vertices_count;
+       index += 1 + get_geometric_skip(GREEN_EDGE_PROB)) {
+    std::advance(it, index - it_index);
+    it_index = index;
+    graph.add_edge(it->first, it->first, EdgeColor::Green);
   }
 }
 
@@ -57,12 +73,16 @@ void generate_blue_edges(Graph& graph) {
     // copy is needed since get_vertices_at_depth() returns a const reference to
     // a changing object
     const auto same_depth_vertices = graph.get_vertices_at_depth(cur_depth);
-    for (auto it = same_depth_vertices.begin();
-         std::next(it) != same_depth_vertices.end(); ++it) {
+    const int pairs_count = (int)same_depth_vertices.size() - 1;
+    auto it = same_depth_vertices.begin();
+    int it_index = 0;
+    for (int index = get_geometric_skip(BLUE_EDGE_PROB); index < pairs_count;
+         index += 1 + get_geometric_skip(BLUE_EDGE_PROB)) {
+      std::advance(it, index - it_index);
+      it_index = index;
       const auto& vertex1_id = *it;
       const auto& vertex2_id = *std::next(it);
-      if (is_lucky(BLUE_EDGE_PROB) &&
-          !graph.is_connected(vertex1_id, vertex2_id)) {
+      if (!graph.is_connected(vertex1_id, vertex2_id)) {
         graph.add_edge(vertex1_id, vertex2_id, EdgeColor::Blue);
       }
     }
@@ -101,18 +121,22 @@ void generate_red_edges(Graph& graph) {
     // copy is needed since get_vertices_at_depth() returns a const reference to
     // a changing object
     const auto cur_depth_vertices = graph.get_vertices_at_depth(cur_depth);
-    for (const auto& cur_vertex_id : cur_depth_vertices) {
+    const int vertices_count = cur_depth_vertices.size();
+    auto it = cur_depth_vertices.begin();
+    int it_index = 0;
+    for (int index = get_geometric_skip(RED_EDGE_PROB); index < vertices_count;
+         index += 1 + get_geometric_skip(RED_EDGE_PROB)) {
       if (cur_depth + 2 > graph.max_depth()) {
         break;
       }
+      std::advance(it, index - it_index);
+      it_index = index;
       // copy is needed since get_vertices_at_depth() returns a const reference
       // to a changing object
       const auto next_depth_vertices =
           graph.get_vertices_at_depth(cur_depth + 2);
-      if (is_lucky(RED_EDGE_PROB)) {
-        const auto chosen_vertex_id = get_random_vertex_id(next_depth_vertices);
-        graph.add_edge(cur_vertex_id, chosen_vertex_id, EdgeColor::Red);
-      }
+      const auto chosen_vertex_id = get_random_vertex_id(next_depth_vertices);
+      graph.add_edge(*it, chosen_vertex_id, EdgeColor::Red);
     }
   }
 }
@@ -3,6 +3,16 @@
 #include <cassert>
 #include <stdexcept>
 
+namespace {
+/*Grows geometrically, so reserving for many small groups stays cheap*/
+template <typename T>
+void reserve_more(std::vector<T>& container, int count) {
+  const auto required_size = container.size() + count;
+  if (required_size > container.capacity())
+    container.reserve(std::max(required_size, 2 * container.capacity()));
+}
+}  // namespace
+
 // VERTEX
 Vertex::Vertex(const VertexId& vertex_id) : id(vertex_id) {}
 
@@ -63,6 +73,35 @@ void Graph::add_edge(const VertexId& from_vertex_id,
   }
 }
 
+VertexId Graph::add_children(const VertexId& parent_vertex_id, int count) {
+  assert(has_vertex_id(parent_vertex_id) &&
+         "There is no such vertex in the graph.");
+  assert(count >= 0 && "Children count can't be negative.");
+
+  const Depth child_depth = vertices_[parent_vertex_id].depth + 1;
+  if (Depth(depth_map_.size()) == child_depth)
+    depth_map_.push_back({});
+  auto& depth_vertex_ids = depth_map_[child_depth];
+  reserve_more(vertices_, count);
+  reserve_more(edges_, count);
+  reserve_more(depth_vertex_ids, count);
+  auto& parent_vertex = vertices_[parent_vertex_id];
+  parent_vertex.reserve_edge_ids(parent_vertex.get_edge_ids().size() + count);
+
+  const VertexId first_child_id = vertex_id_counter_;
+  for (int i = 0; i < count; i++) {
+    auto& child_vertex = vertices_.emplace_back(get_new_vertex_id());
+    const auto& new_edge =
+        edges_.emplace_back(get_new_edge_id(), parent_vertex_id,
+                            child_vertex.id, Edge::Color::Grey);
+    child_vertex.depth = child_depth;
+    child_vertex.add_edge_id(new_edge.id);
+    parent_vertex.add_edge_id(new_edge.id);
+    depth_vertex_ids.push_back(child_vertex.id);
+  }
+  return first_child_id;
+}
+
 Edge::Color Graph::get_edge_color(const Vertex& from_vertex,
                                   const Vertex& to_vertex) {
   const auto& from_vertex_depth = from_vertex.depth;
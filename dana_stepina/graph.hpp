@@ -13,6 +13,7 @@ struct Vertex {
   explicit Vertex(const VertexId& vertex_id);
 
   void add_edge_id(const EdgeId& edge_id);
+  void reserve_edge_ids(int count) { edge_ids_.reserve(count); }
   const std::vector<EdgeId>& get_edge_ids() const { return edge_ids_; }
   bool has_edge_id(const EdgeId& edge_id) const;
 
@@ -38,6 +39,9 @@ class Graph {
  public:
   const Vertex& add_vertex();
   void add_edge(const VertexId& from_vertex_id, const VertexId& to_vertex_id);
+  /*Adds count children of the vertex with grey edges to them, storage is
+   * reserved once for the whole group. Returns the id of the first child*/
+  VertexId add_children(const VertexId& parent_vertex_id, int count);
 
   const std::vector<Edge>& get_edges() const { return edges_; }
   const std::vector<Vertex>& get_vertices() const { return vertices_; }
@@ -21,6 +21,14 @@ bool is_lucky(Probability probability) {
   return distribution(generator);
 }
 
+int get_children_count(int new_vertices_num, Probability probability) {
+  /*Seeded once per thread: one draw per parent costs no random_device call*/
+  thread_local std::mt19937 generator(std::random_device{}());
+  std::binomial_distribution<int> distribution(new_vertices_num,
+                                               probability * 0.01);
+  return distribution(generator);
+}
+
 VertexId choose_random_vertex_id(const std::vector<VertexId>& vertex_ids) {
   std::random_device rand;
   std::default_random_engine generator(rand());
@@ -39,13 +47,15 @@ void generate_grey_edges(Graph& graph, const GraphGenerator::Params& params) {
 
     bool any_new_vertex_generated = false;
 
-    for (const auto& vertex_id : vertex_ids)
-      for (int i = 0; i < params.new_vertices_num; i++)
-        if (is_lucky(probability)) {
-          const auto& new_vertex = graph.add_vertex();
-          graph.add_edge(vertex_id, new_vertex.id);
-          any_new_vertex_generated = true;
-        }
+    for (const auto& vertex_id : vertex_ids) {
+      /*One draw per vertex instead of new_vertices_num separate trials*/
+      const int children_count =
+          get_children_count(params.new_vertices_num, probability);
+      if (children_count > 0) {
+        graph.add_children(vertex_id, children_count);
+        any_new_vertex_generated = true;
+      }
+    }
 
     if (!any_new_vertex_generated)
       break;
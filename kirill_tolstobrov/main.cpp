@@ -1,6 +1,8 @@
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <iterator>
@@ -8,6 +10,11 @@
 #include <random>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_RANDOM_X86
+#include <immintrin.h>
+#endif
+
 constexpr float GREEN_PROB = 0.1;
 constexpr float BLUE_PROB = 0.25;
 constexpr float RED_PROB = 0.33;
@@ -137,6 +144,43 @@ class Graph {
     return new_id;
   }
 
+  // Adds count children of parent_id with grey edges at once: storage is
+  // reserved for the whole group. Returns the id of the first child.
+  VertexId add_children(const VertexId& parent_id, int count) {
+    assert(check_vertex_existence(parent_id) &&
+           "Attemptig to access to nonexistent vertex: Error.");
+    const int child_depth = get_vertex(parent_id).depth + 1;
+    if (int(depths_map_.size()) - 1 < child_depth) {
+      depths_map_.emplace_back();
+    }
+    auto& vertex_ids_at_depth = depths_map_[child_depth];
+    auto& parent_edge_ids = connections_map_[parent_id];
+    auto& grey_edge_ids = colors_map_[Edge::Color::Grey];
+    reserve_more(vertices_, count);
+    reserve_more(edges_, count);
+    reserve_more(vertex_ids_at_depth, count);
+    reserve_more(grey_edge_ids, count);
+    parent_edge_ids.reserve(parent_edge_ids.size() + count);
+    // vertices_ is reserved above, so the reference survives the emplaces
+    auto& parent = get_vertex(parent_id);
+
+    const VertexId first_child_id = vertex_id_counter_;
+    for (int i = 0; i < count; i++) {
+      const VertexId child_id = get_new_vertex_id();
+      const EdgeId edge_id = get_new_edge_id();
+      auto& child = vertices_.emplace_back(child_id);
+      child.depth = child_depth;
+      child.add_edge_id(edge_id);
+      parent.add_edge_id(edge_id);
+      edges_.emplace_back(edge_id, parent_id, child_id, Edge::Color::Grey);
+      parent_edge_ids.push_back(edge_id);
+      connections_map_[child_id].push_back(edge_id);
+      grey_edge_ids.push_back(edge_id);
+      vertex_ids_at_depth.push_back(child_id);
+    }
+    return first_child_id;
+  }
+
   bool check_vertex_existence(const VertexId& vertex_id) const {
     for (const auto& vertex : vertices_) {
       if (vertex_id == vertex.id) {
@@ -270,8 +314,71 @@ class Graph {
 
   VertexId get_new_vertex_id() { return vertex_id_counter_++; }
   EdgeId get_new_edge_id() { return edge_id_counter_++; }
+
+  // Grows geometrically, so reserving for many small groups stays cheap
+  template <typename T>
+  static void reserve_more(std::vector<T>& container, int count) {
+    const auto required_size = container.size() + count;
+    if (required_size > container.capacity()) {
+      container.reserve(std::max(required_size, 2 * container.capacity()));
+    }
+  }
 };
 
+// Batch Bernoulli kernel: decision i comes from xorshift32 lane i % 8 at
+// step i / 8 and is true when the top 24 bits of the lane, as a float in
+// [0, 1), are below the probability. The AVX2 path steps all 8 lanes at once,
+// the scalar one lane by lane; both give the same decisions.
+constexpr int RANDOM_LANES = 8;
+constexpr float UINT24_TO_FLOAT = 1.0f / (1 << 24);
+using RandomLanes = std::array<uint32_t, RANDOM_LANES>;
+
+void random_bools_scalar(RandomLanes& lanes,
+                         int first_index,
+                         float true_prob,
+                         std::vector<bool>& decisions) {
+  for (int i = first_index; i < int(decisions.size()); i++) {
+    uint32_t& lane = lanes[i % RANDOM_LANES];
+    lane ^= lane << 13;
+    lane ^= lane >> 17;
+    lane ^= lane << 5;
+    decisions[i] = (lane >> 8) * UINT24_TO_FLOAT < true_prob;
+  }
+}
+
+#ifdef BATCH_RANDOM_X86
+bool has_avx2() {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+
+// Returns the number of filled decisions (a multiple of RANDOM_LANES)
+__attribute__((target("avx2"))) int random_bools_avx2(
+    RandomLanes& lanes,
+    float true_prob,
+    std::vector<bool>& decisions) {
+  const __m256 scale = _mm256_set1_ps(UINT24_TO_FLOAT);
+  const __m256 threshold = _mm256_set1_ps(true_prob);
+  __m256i state =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.data()));
+  int i = 0;
+  for (; i + RANDOM_LANES <= int(decisions.size()); i += RANDOM_LANES) {
+    state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+    state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+    state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+    const __m256 random_floats =
+        _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(state, 8)), scale);
+    const int bits =
+        _mm256_movemask_ps(_mm256_cmp_ps(random_floats, threshold, _CMP_LT_OQ));
+    for (int lane = 0; lane < RANDOM_LANES; lane++) {
+      decisions[i + lane] = (bits >> lane) & 1;
+    }
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.data()), state);
+  return i;
+}
+#endif
+
 class GraphGenerator {
  public:
   struct Params {
@@ -300,10 +407,39 @@ class GraphGenerator {
  private:
   const Params params_ = Params();
 
-  bool random_bool(float true_prob) const {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::bernoulli_distribution d(true_prob);
+  // Lanes are seeded once per thread and then keep running from call to
+  // call, so a layer's pass costs no random_device syscall
+  static RandomLanes& get_random_lanes() {
+    thread_local RandomLanes lanes = [] {
+      std::random_device rd;
+      std::mt19937 gen(rd());
+      RandomLanes seeded_lanes;
+      for (auto& lane : seeded_lanes) {
+        lane = gen() | 1;  // xorshift state must not be zero
+      }
+      return seeded_lanes;
+    }();
+    return lanes;
+  }
+
+  // count decisions drawn in one call, see random_bools_scalar
+  std::vector<bool> random_bools(int count, float true_prob) const {
+    auto& lanes = get_random_lanes();
+    std::vector<bool> decisions(std::max(count, 0));
+    int first_scalar_index = 0;
+#ifdef BATCH_RANDOM_X86
+    if (has_avx2()) {
+      first_scalar_index = random_bools_avx2(lanes, true_prob, decisions);
+    }
+#endif
+    random_bools_scalar(lanes, first_scalar_index, true_prob, decisions);
+    return decisions;
+  }
+
+  // seeded once per thread like the lanes, one draw per parent is cheap
+  int random_binomial(int trials, float success_prob) const {
+    thread_local std::mt19937 gen(std::random_device{}());
+    std::binomial_distribution<int> d(trials, success_prob);
     return d(gen);
   }
 
@@ -324,13 +460,14 @@ class GraphGenerator {
       if (graph.depths_map_.size() - 1 < cur_depth) {
         return;
       }
-      const auto& vertex_ids_at_depth = graph.depths_map_[cur_depth];
+      // copy: adding children may reallocate depths_map_
+      const auto vertex_ids_at_depth = graph.depths_map_[cur_depth];
       for (const VertexId cur_vertex_id : vertex_ids_at_depth) {
-        for (int k = 0; k < new_vertices_num; k++) {
-          if (random_bool(new_vertex_prob)) {
-            const auto new_vertex_id = graph.add_new_vertex();
-            graph.bind_vertices(cur_vertex_id, new_vertex_id);
-          }
+        // one draw per vertex instead of new_vertices_num random_bool calls
+        const int children_count =
+            random_binomial(new_vertices_num, new_vertex_prob);
+        if (children_count > 0) {
+          graph.add_children(cur_vertex_id, children_count);
         }
       }
       new_vertex_prob -= probability_decreasement;
@@ -338,9 +475,11 @@ class GraphGenerator {
   }
 
   void generate_green_edges(Graph& graph) const {
-    for (const auto& cur_vertex : graph.get_vertices()) {
-      if (random_bool(GREEN_PROB)) {
-        graph.bind_vertices(cur_vertex.id, cur_vertex.id);
+    const auto& vertices = graph.get_vertices();
+    const auto decisions = random_bools(vertices.size(), GREEN_PROB);
+    for (int i = 0; i < int(vertices.size()); i++) {
+      if (decisions[i]) {
+        graph.bind_vertices(vertices[i].id, vertices[i].id);
       }
     }
   }
@@ -348,9 +487,12 @@ class GraphGenerator {
   void generate_blue_edges(Graph& graph) const {
     for (int cur_depth = 0; cur_depth < graph.depths_map_.size(); cur_depth++) {
       const auto& vertex_ids_at_depth = graph.depths_map_[cur_depth];
-      const int last_id = vertex_ids_at_depth[vertex_ids_at_depth.size() - 1];
-      for (const VertexId cur_id : vertex_ids_at_depth) {
-        if (cur_id != last_id && random_bool(BLUE_PROB)) {
+      // one decision per vertex except the last one
+      const auto decisions =
+          random_bools(vertex_ids_at_depth.size() - 1, BLUE_PROB);
+      for (int i = 0; i < int(decisions.size()); i++) {
+        if (decisions[i]) {
+          const VertexId cur_id = vertex_ids_at_depth[i];
           graph.bind_vertices(cur_id, cur_id + 1);
         }
       }
@@ -364,8 +506,11 @@ class GraphGenerator {
          cur_depth++) {
       const auto& vertex_ids_at_depth = graph.depths_map_[cur_depth];
       const auto& vertex_ids_at_next_depth = graph.depths_map_[cur_depth + 1];
-      for (const VertexId cur_id : vertex_ids_at_depth) {
-        if (random_bool(yellow_probability)) {
+      const auto decisions =
+          random_bools(vertex_ids_at_depth.size(), yellow_probability);
+      for (int i = 0; i < int(vertex_ids_at_depth.size()); i++) {
+        const VertexId cur_id = vertex_ids_at_depth[i];
+        if (decisions[i]) {
           std::vector<VertexId> possible_connections;
           for (const VertexId next_id : vertex_ids_at_next_depth) {
             if (!graph.are_vertices_connected(cur_id, next_id)) {
@@ -386,11 +531,12 @@ class GraphGenerator {
     for (int cur_depth = 0; cur_depth < graph.depths_map_.size() - 2;
          cur_depth++) {
       const auto& vertex_ids_at_depth = graph.depths_map_[cur_depth];
-      for (const VertexId cur_id : vertex_ids_at_depth) {
-        if (random_bool(RED_PROB)) {
+      const auto decisions = random_bools(vertex_ids_at_depth.size(), RED_PROB);
+      for (int i = 0; i < int(vertex_ids_at_depth.size()); i++) {
+        if (decisions[i]) {
           const VertexId binding_id =
               random_vertex_id(graph.depths_map_[cur_depth + 2]);
-          graph.bind_vertices(cur_id, binding_id);
+          graph.bind_vertices(vertex_ids_at_depth[i], binding_id);
         }
       }
     }
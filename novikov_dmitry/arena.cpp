@@ -0,0 +1,61 @@
+#include "arena.hpp"
+#include <algorithm>
+
+namespace uni_cpp_practice {
+
+void Arena::reset() {
+  if (blocks_.size() > 1) {
+    const auto capacity_bytes = get_capacity_bytes();
+    blocks_.clear();
+    add_block(capacity_bytes);
+  }
+  block_used_bytes_ = 0;
+  full_blocks_bytes_ = 0;
+}
+
+std::size_t Arena::get_used_bytes() const {
+  return full_blocks_bytes_ + block_used_bytes_;
+}
+
+std::size_t Arena::get_capacity_bytes() const {
+  std::size_t capacity_bytes = 0;
+  for (const auto& block : blocks_) {
+    capacity_bytes += block.size;
+  }
+  return capacity_bytes;
+}
+
+void Arena::add_block(std::size_t min_bytes) {
+  // Блоки растут вдвое, как и то, что в них обычно лежит
+  const auto block_bytes =
+      std::max({min_bytes, first_block_bytes_,
+                blocks_.empty() ? 0 : 2 * blocks_.back().size});
+  if (!blocks_.empty()) {
+    full_blocks_bytes_ += block_used_bytes_;
+  }
+  blocks_.push_back(
+      {std::unique_ptr<std::byte[]>(new std::byte[block_bytes]), block_bytes});
+  block_used_bytes_ = 0;
+}
+
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (!blocks_.empty()) {
+    auto& block = blocks_.back();
+    void* ptr = block.data.get() + block_used_bytes_;
+    auto space = block.size - block_used_bytes_;
+    if (std::align(alignment, bytes, ptr, space) != nullptr) {
+      block_used_bytes_ = block.size - space + bytes;
+      return ptr;
+    }
+  }
+  // В новом блоке хватит места и с учетом выравнивания
+  add_block(bytes + alignment);
+  auto& block = blocks_.back();
+  void* ptr = block.data.get();
+  auto space = block.size;
+  std::align(alignment, bytes, ptr, space);
+  block_used_bytes_ = block.size - space + bytes;
+  return ptr;
+}
+
+}  // namespace uni_cpp_practice
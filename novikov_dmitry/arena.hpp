@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace uni_cpp_practice {
+
+// Монотонная арена: выделения идут подряд из блоков, deallocate ничего
+// не делает, а reset за O(число блоков) освобождает все разом и
+// оставляет память для следующего использования. Если с прошлого reset
+// понадобилось несколько блоков, reset заменяет их одним блоком общего
+// размера: когда задания между reset похожи по размеру, после первых
+// заданий арена больше не обращается к куче. Не потокобезопасна.
+class Arena : public std::pmr::memory_resource {
+ public:
+  explicit Arena(std::size_t first_block_bytes = DEFAULT_FIRST_BLOCK_BYTES)
+      : first_block_bytes_(first_block_bytes) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Все выделенное арене становится недействительным
+  void reset();
+
+  std::size_t get_used_bytes() const;
+  std::size_t get_capacity_bytes() const;
+
+ private:
+  static constexpr std::size_t DEFAULT_FIRST_BLOCK_BYTES = 64 * 1024;
+
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size = 0;
+  };
+
+  const std::size_t first_block_bytes_;
+  std::vector<Block> blocks_;
+  // Занятая часть последнего блока и всех предыдущих
+  std::size_t block_used_bytes_ = 0;
+  std::size_t full_blocks_bytes_ = 0;
+
+  void add_block(std::size_t min_bytes);
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+}  // namespace uni_cpp_practice
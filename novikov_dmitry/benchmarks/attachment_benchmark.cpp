@@ -0,0 +1,47 @@
+// Серое дерево режима PreferentialAttachment против Layers с теми же
+// параметрами: время на вершину не должно расти с размером графа,
+// присоединение вершины - O(1).
+//
+// Сборка из папки novikov_dmitry:
+//   clang++ benchmarks/attachment_benchmark.cpp graph.cpp graph_generator.cpp
+//     graph_printer.cpp graph_validation.cpp graph_variant.cpp
+//     random_source.cpp -o benchmarks/attachment_benchmark
+//     -std=c++17 -O2 -pthread
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../graph_generator.hpp"
+
+namespace {
+
+using uni_cpp_practice::Depth;
+using uni_cpp_practice::GraphGenerator;
+
+constexpr int NEW_VERTICES_NUM = 4;
+constexpr uni_cpp_practice::RandomSource::Seed SEED = 42;
+
+void run(const std::string& name,
+         const Depth& depth,
+         const GraphGenerator::GrayMode& gray_mode) {
+  const auto generator = GraphGenerator(
+      GraphGenerator::Params(depth, NEW_VERTICES_NUM, SEED, gray_mode));
+  const auto start = std::chrono::steady_clock::now();
+  const auto skeleton = generator.generate_skeleton();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const auto vertices_count = skeleton->get_vertex_map().size();
+  std::cout << name << " depth " << depth << ": " << vertices_count
+            << " vertices, graph depth " << skeleton->get_depth() << ", "
+            << elapsed.count() * 1e9 / vertices_count << " ns/vertex\n";
+}
+
+}  // namespace
+
+int main() {
+  for (const Depth depth : {12, 16, 20}) {
+    run("layers", depth, GraphGenerator::GrayMode::Layers);
+    run("attachment", depth,
+        GraphGenerator::GrayMode::PreferentialAttachment);
+  }
+  return 0;
+}
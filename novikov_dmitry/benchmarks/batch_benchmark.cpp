@@ -0,0 +1,60 @@
+// Маленькие графы: GRAPHS_COUNT вызовов generate против одного
+// generate_batch на тех же параметрах. Печатает графы в секунду.
+//
+// Сборка из папки novikov_dmitry:
+//   clang++ benchmarks/batch_benchmark.cpp graph.cpp graph_generator.cpp
+//     graph_printer.cpp graph_validation.cpp graph_variant.cpp
+//     random_source.cpp -o benchmarks/batch_benchmark -std=c++17 -O2
+//     -pthread
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../graph_generator.hpp"
+
+namespace {
+
+using uni_cpp_practice::Depth;
+using uni_cpp_practice::GraphGenerator;
+
+constexpr int GRAPHS_COUNT = 20000;
+constexpr uni_cpp_practice::RandomSource::Seed SEED = 42;
+
+// Вызывает generate_all, возвращающий суммарное число вершин графов
+template <typename GenerateAll>
+void run(const std::string& name, const GenerateAll& generate_all) {
+  const auto start = std::chrono::steady_clock::now();
+  const long long vertices_count = generate_all();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const auto graphs_per_second =
+      static_cast<long long>(GRAPHS_COUNT / elapsed.count());
+  std::cout << "  " << name << ": " << graphs_per_second
+            << " graphs/s (vertices " << vertices_count << ")\n";
+}
+
+}  // namespace
+
+int main() {
+  const std::vector<std::pair<Depth, int>> params = {{3, 2}, {4, 3}, {5, 3}};
+  for (const auto& [depth, new_vertices_num] : params) {
+    std::cout << "depth " << depth << ", new_vertices_num "
+              << new_vertices_num << ":\n";
+    const auto generator =
+        GraphGenerator(GraphGenerator::Params(depth, new_vertices_num, SEED));
+    run("generate", [&generator]() {
+      long long vertices_count = 0;
+      for (int graph_index = 0; graph_index < GRAPHS_COUNT; ++graph_index) {
+        vertices_count +=
+            generator.generate(graph_index).get_vertex_map().size();
+      }
+      return vertices_count;
+    });
+    run("generate_batch", [&generator]() {
+      return static_cast<long long>(
+          generator.generate_batch(0, GRAPHS_COUNT).vertex_depths.size());
+    });
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+// Цветные ребра одним проходом по уровню (ColorKernel::Fused) против
+// отдельного прохода на каждый цвет (ColorKernel::Passes). Серое дерево
+// строится одинаково, поэтому разница во времени - это цветные ребра.
+// В Passes желтые ребра ищутся перебором следующего уровня, поэтому
+// на больших графах он сравнивается с выключенными желтыми ребрами.
+//
+// Сборка из папки novikov_dmitry:
+//   clang++ benchmarks/color_kernel_benchmark.cpp graph.cpp graph_generator.cpp
+//     graph_printer.cpp graph_validation.cpp graph_variant.cpp
+//     random_source.cpp -o benchmarks/color_kernel_benchmark
+//     -std=c++17 -O2 -pthread
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../graph_generator.hpp"
+
+namespace {
+
+using uni_cpp_practice::BasicGraphGenerator;
+using uni_cpp_practice::Depth;
+using uni_cpp_practice::Edge;
+using uni_cpp_practice::RuntimePolicy;
+using uni_cpp_practice::ValidationMode;
+using ColorKernel = uni_cpp_practice::GraphGeneratorBase::ColorKernel;
+using GrayMode = uni_cpp_practice::GraphGeneratorBase::GrayMode;
+using Params = uni_cpp_practice::GraphGeneratorBase::Params;
+
+constexpr uni_cpp_practice::RandomSource::Seed SEED = 42;
+
+// Возвращает число ребер графа, чтобы сверить ядра между собой
+int run(const std::string& name,
+        const Depth& depth,
+        int new_vertices_num,
+        const RuntimePolicy& policy,
+        const ColorKernel& color_kernel) {
+  const auto generator = BasicGraphGenerator<RuntimePolicy>(
+      Params(depth, new_vertices_num, SEED, GrayMode::Layers,
+             ValidationMode::Off, color_kernel),
+      policy);
+  const auto start = std::chrono::steady_clock::now();
+  const auto graph = generator.generate();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const int edges_count = graph.get_edge_map().size();
+  std::cout << name << ", depth " << depth << ", new vertices "
+            << new_vertices_num << ": " << elapsed.count() << " sec, edges "
+            << edges_count << "\n";
+  return edges_count;
+}
+
+void compare(const Depth& depth,
+             int new_vertices_num,
+             const RuntimePolicy& policy,
+             const std::string& policy_name) {
+  const int passes_edges_count = run("passes, " + policy_name, depth,
+                                     new_vertices_num, policy,
+                                     ColorKernel::Passes);
+  const int fused_edges_count = run("fused, " + policy_name, depth,
+                                    new_vertices_num, policy,
+                                    ColorKernel::Fused);
+  if (passes_edges_count != fused_edges_count) {
+    std::cout << "edges count differs!\n";
+  }
+}
+
+}  // namespace
+
+int main() {
+  const auto all_colors = RuntimePolicy();
+  compare(10, 4, all_colors, "all colors");
+  compare(12, 4, all_colors, "all colors");
+
+  auto no_yellow = RuntimePolicy();
+  no_yellow.set_color_probability(Edge::Color::Yellow, 0);
+  compare(12, 4, no_yellow, "no yellow");
+  // больше 10 миллионов ребер
+  compare(14, 6, no_yellow, "no yellow");
+  run("fused, all colors", 14, 6, all_colors, ColorKernel::Fused);
+  return 0;
+}
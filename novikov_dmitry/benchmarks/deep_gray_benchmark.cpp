@@ -0,0 +1,53 @@
+// Стресс-тест серого дерева на больших глубинах (10^4 и больше) для обоих
+// способов построения. При new_vertices_num = 1 у вершины не больше одного
+// ребенка, поэтому дерево узкое, а пути в нем - длиной в тысячи уровней.
+//
+// Сборка из папки novikov_dmitry:
+//   clang++ benchmarks/deep_gray_benchmark.cpp graph.cpp graph_generator.cpp
+//     graph_printer.cpp graph_validation.cpp graph_variant.cpp
+//     random_source.cpp -o benchmarks/deep_gray_benchmark
+//     -std=c++17 -O2 -pthread
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../graph_generator.hpp"
+
+namespace {
+
+using uni_cpp_practice::Depth;
+using uni_cpp_practice::GraphGenerator;
+
+constexpr int NEW_VERTICES_NUM = 1;
+constexpr int GRAPHS_COUNT = 200;
+constexpr uni_cpp_practice::RandomSource::Seed SEED = 42;
+
+void run(const std::string& name,
+         const Depth& depth,
+         const GraphGenerator::GrayMode& gray_mode) {
+  const auto generator = GraphGenerator(
+      GraphGenerator::Params(depth, NEW_VERTICES_NUM, SEED, gray_mode));
+  const auto start = std::chrono::steady_clock::now();
+  Depth max_depth = 0;
+  long long vertices_count = 0;
+  for (int graph_index = 0; graph_index < GRAPHS_COUNT; ++graph_index) {
+    const auto graph = generator.generate(graph_index);
+    max_depth = std::max(max_depth, graph.get_depth());
+    vertices_count += graph.get_vertex_map().size();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << name << ", depth " << depth << ": " << elapsed.count()
+            << " sec, max reached depth " << max_depth << ", vertices "
+            << vertices_count << "\n";
+}
+
+}  // namespace
+
+int main() {
+  for (const Depth depth : {10000, 100000, 1000000}) {
+    run("branches", depth, GraphGenerator::GrayMode::Branches);
+    run("layers", depth, GraphGenerator::GrayMode::Layers);
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Сравнение скорости выборок: старый способ (движок создается на каждую
+// выборку) против счетчикового RandomSource, а также is_lucky по потокам
+// вершин против маски fill_lucky_mask на весь уровень.
+//
+// Сборка из папки novikov_dmitry:
+//   clang++ benchmarks/random_source_benchmark.cpp random_source.cpp
+//     -o benchmarks/random_source_benchmark -std=c++17 -O2
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "../random_source.hpp"
+
+namespace {
+
+using uni_cpp_practice::Edge;
+using uni_cpp_practice::LuckyMask;
+using uni_cpp_practice::RandomSource;
+using uni_cpp_practice::VertexId;
+
+constexpr int DRAWS_COUNT = 200000;
+constexpr float PROBABILITY = 0.25;
+constexpr int NUMBERS_RANGE = 100;
+constexpr int LAYER_SIZE = 1000;
+
+// Так выборки делались до появления RandomSource
+bool is_lucky_per_draw(float probability) {
+  static std::knuth_b rand_engine{};
+  std::mt19937 rng{rand_engine()};
+  std::bernoulli_distribution bernoulli_distribution_var(probability);
+  return bernoulli_distribution_var(rng);
+}
+
+int get_random_number_per_draw(int size) {
+  std::random_device rd;
+  std::default_random_engine gen(rd());
+  std::uniform_int_distribution<int> distrib(0, size - 1);
+  return distrib(gen);
+}
+
+void print_result(const std::string& name,
+                  const std::chrono::steady_clock::time_point& start,
+                  int checksum) {
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const auto draws_per_second =
+      static_cast<long long>(DRAWS_COUNT / elapsed.count());
+  std::cout << name << ": " << draws_per_second << " draws/sec (checksum "
+            << checksum << ")\n";
+}
+
+template <typename Draw>
+void run(const std::string& name, const Draw& draw) {
+  const auto start = std::chrono::steady_clock::now();
+  int checksum = 0;
+  for (int i = 0; i < DRAWS_COUNT; ++i) {
+    checksum += draw();
+  }
+  print_result(name, start, checksum);
+}
+
+// Решения для уровней из LAYER_SIZE вершин, всего DRAWS_COUNT решений
+template <typename DrawLayer>
+void run_layers(const std::string& name, const DrawLayer& draw_layer) {
+  auto vertex_ids = std::vector<VertexId>(LAYER_SIZE);
+  std::iota(vertex_ids.begin(), vertex_ids.end(), 0);
+  const auto start = std::chrono::steady_clock::now();
+  int checksum = 0;
+  for (int i = 0; i < DRAWS_COUNT; i += LAYER_SIZE) {
+    checksum += draw_layer(vertex_ids);
+  }
+  print_result(name, start, checksum);
+}
+
+}  // namespace
+
+int main() {
+  auto random_source =
+      uni_cpp_practice::RandomSource(std::random_device()(), {});
+  run("is_lucky, engine per draw",
+      []() { return is_lucky_per_draw(PROBABILITY); });
+  run("is_lucky, RandomSource",
+      [&random_source]() { return random_source.is_lucky(PROBABILITY); });
+  run("get_random_number, engine per draw",
+      []() { return get_random_number_per_draw(NUMBERS_RANGE); });
+  run("get_random_number, RandomSource", [&random_source]() {
+    return random_source.get_random_number(NUMBERS_RANGE);
+  });
+  const auto seed = RandomSource::Seed(42);
+  run_layers("layer decisions, is_lucky per vertex",
+             [&seed](const std::vector<VertexId>& vertex_ids) {
+               int lucky_count = 0;
+               for (const auto& vertex_id : vertex_ids) {
+                 auto vertex_random_source = RandomSource(
+                     seed, {0, vertex_id, Edge::Color::Yellow});
+                 lucky_count += vertex_random_source.is_lucky(PROBABILITY);
+               }
+               return lucky_count;
+             });
+  LuckyMask lucky_mask;
+  run_layers("layer decisions, fill_lucky_mask",
+             [&seed, &lucky_mask](const std::vector<VertexId>& vertex_ids) {
+               uni_cpp_practice::fill_lucky_mask(seed, 0, Edge::Color::Yellow,
+                                                 vertex_ids, PROBABILITY,
+                                                 lucky_mask);
+               int lucky_count = 0;
+               for (const auto& word : lucky_mask) {
+                 lucky_count += __builtin_popcountll(word);
+               }
+               return lucky_count;
+             });
+  return 0;
+}
@@ -0,0 +1,59 @@
+// Скорость generate_stats против полного generate на одних и тех же
+// параметрах: сколько наборов параметров в минуту можно оценить.
+//
+// Сборка из папки novikov_dmitry:
+//   clang++ benchmarks/stats_benchmark.cpp graph.cpp graph_generator.cpp
+//     graph_printer.cpp graph_validation.cpp graph_variant.cpp
+//     random_source.cpp -o benchmarks/stats_benchmark -std=c++17 -O2 -pthread
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../graph_generator.hpp"
+
+namespace {
+
+using uni_cpp_practice::Depth;
+using uni_cpp_practice::GraphGenerator;
+
+constexpr Depth MAX_DEPTH = 6;
+constexpr int MAX_NEW_VERTICES_NUM = 4;
+constexpr int GRAPHS_COUNT = 200;
+constexpr uni_cpp_practice::RandomSource::Seed SEED = 42;
+
+// Обходит все наборы (depth, new_vertices_num, graph_index) и для каждого
+// вызывает generate_one, возвращающий число вершин
+template <typename GenerateOne>
+void run(const std::string& name, const GenerateOne& generate_one) {
+  const auto start = std::chrono::steady_clock::now();
+  long long vertices_count = 0;
+  int params_count = 0;
+  for (Depth depth = 1; depth <= MAX_DEPTH; ++depth) {
+    for (int new_vertices_num = 1; new_vertices_num <= MAX_NEW_VERTICES_NUM;
+         ++new_vertices_num) {
+      const auto generator = GraphGenerator(
+          GraphGenerator::Params(depth, new_vertices_num, SEED));
+      for (int graph_index = 0; graph_index < GRAPHS_COUNT; ++graph_index) {
+        vertices_count += generate_one(generator, graph_index);
+        ++params_count;
+      }
+    }
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const auto params_per_minute =
+      static_cast<long long>(params_count / elapsed.count() * 60);
+  std::cout << name << ": " << params_per_minute
+            << " parameter sets/min (vertices " << vertices_count << ")\n";
+}
+
+}  // namespace
+
+int main() {
+  run("generate", [](const GraphGenerator& generator, int graph_index) {
+    return generator.generate(graph_index).get_vertex_map().size();
+  });
+  run("generate_stats", [](const GraphGenerator& generator, int graph_index) {
+    return generator.generate_stats(graph_index).count_vertices();
+  });
+  return 0;
+}
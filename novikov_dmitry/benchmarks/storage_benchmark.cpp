@@ -0,0 +1,66 @@
+// Хранилища Graph: DenseGraphStorage (вектор по id, по умолчанию) против
+// HashGraphStorage. Для каждого печатает скорость add_edge на готовых
+// вершинах и get_vertex в случайном порядке.
+//
+// Сборка из папки novikov_dmitry:
+//   clang++ benchmarks/storage_benchmark.cpp graph.cpp
+//     -o benchmarks/storage_benchmark -std=c++17 -O2
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../graph.hpp"
+
+namespace {
+
+using uni_cpp_practice::Edge;
+using uni_cpp_practice::VertexId;
+
+constexpr int VERTICES_COUNT = 1 << 20;
+constexpr int LOOKUPS_COUNT = 1 << 24;
+
+template <typename Graph>
+void run(const std::string& name) {
+  auto graph = Graph();
+  graph.set_validation_mode(uni_cpp_practice::ValidationMode::Off);
+  graph.add_vertex();
+  // Одноуровневое дерево: все вершины, кроме нулевой, на глубине 1
+  graph.add_children(0, VERTICES_COUNT - 1);
+
+  // Синие ребра между соседями по уровню
+  auto start = std::chrono::steady_clock::now();
+  for (VertexId vertex_id = 1; vertex_id + 1 < VERTICES_COUNT; ++vertex_id) {
+    graph.add_edge(vertex_id, vertex_id + 1, Edge::Color::Blue);
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const auto edges_per_second =
+      static_cast<long long>((VERTICES_COUNT - 2) / elapsed.count());
+
+  auto random_engine = std::mt19937(42);
+  auto vertex_ids = std::vector<VertexId>(LOOKUPS_COUNT);
+  for (auto& vertex_id : vertex_ids) {
+    vertex_id = random_engine() % VERTICES_COUNT;
+  }
+  long long depths_sum = 0;
+  start = std::chrono::steady_clock::now();
+  for (const auto& vertex_id : vertex_ids) {
+    depths_sum += graph.get_vertex(vertex_id).depth;
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  const auto lookups_per_second =
+      static_cast<long long>(LOOKUPS_COUNT / elapsed.count());
+
+  std::cout << name << ": add_edge " << edges_per_second
+            << "/s, get_vertex " << lookups_per_second
+            << "/s (depths sum " << depths_sum << ")\n";
+}
+
+}  // namespace
+
+int main() {
+  run<uni_cpp_practice::Graph>("dense");
+  run<uni_cpp_practice::HashGraph>("hash");
+  return 0;
+}
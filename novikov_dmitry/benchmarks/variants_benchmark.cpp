@@ -0,0 +1,57 @@
+// Пакет вариантов одного графа: GRAPHS_COUNT полных generate против
+// одного generate_skeleton и GRAPHS_COUNT generate_variant. Печатает время
+// и сколько ребер хранят результаты пакета.
+//
+// Сборка из папки novikov_dmitry:
+//   clang++ benchmarks/variants_benchmark.cpp graph.cpp graph_generator.cpp
+//     graph_printer.cpp graph_validation.cpp graph_variant.cpp
+//     random_source.cpp -o benchmarks/variants_benchmark -std=c++17 -O2
+//     -pthread
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../graph_generator.hpp"
+
+namespace {
+
+using uni_cpp_practice::Graph;
+using uni_cpp_practice::GraphGenerator;
+using uni_cpp_practice::GraphVariant;
+
+constexpr int GRAPHS_COUNT = 20;
+constexpr uni_cpp_practice::RandomSource::Seed SEED = 42;
+
+// Вызывает generate_batch, возвращающий число хранимых ребер пакета
+template <typename GenerateBatch>
+void run(const std::string& name, const GenerateBatch& generate_batch) {
+  const auto start = std::chrono::steady_clock::now();
+  const long long edges_count = generate_batch();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << name << ": " << elapsed.count() << " s, stored edges "
+            << edges_count << "\n";
+}
+
+}  // namespace
+
+int main() {
+  const auto generator =
+      GraphGenerator(GraphGenerator::Params(12, 4, SEED));
+  run("generate", [&generator]() {
+    long long edges_count = 0;
+    for (int i = 0; i < GRAPHS_COUNT; ++i) {
+      edges_count += generator.generate(i).get_edge_map().size();
+    }
+    return edges_count;
+  });
+  run("skeleton + variants", [&generator]() {
+    const auto skeleton = generator.generate_skeleton();
+    long long edges_count = skeleton->get_edge_map().size();
+    for (int i = 0; i < GRAPHS_COUNT; ++i) {
+      const auto variant = generator.generate_variant(skeleton, i);
+      edges_count += variant.count_edges() - skeleton->get_edge_map().size();
+    }
+    return edges_count;
+  });
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include "frozen_graph.hpp"
+#include <cassert>
+
+namespace uni_cpp_practice {
+
+template <typename Storage>
+FrozenGraph::FrozenGraph(const BasicGraph<Storage>& graph) {
+  const int vertices_count = graph.get_vertex_map().size();
+  const int edges_count = graph.get_edge_map().size();
+  edge_vertex_ids_.resize(edges_count);
+  edge_colors_.resize(edges_count);
+  for (const auto& [edge_id, edge] : graph.get_edge_map()) {
+    assert(edge_id < edges_count && "Edge ids must be sequential");
+    edge_vertex_ids_[edge_id] = edge.get_binded_vertices();
+    edge_colors_[edge_id] = edge.color;
+    ++edges_of_color_[int(edge.color)];
+  }
+
+  vertex_ids_.reserve(vertices_count);
+  vertex_indices_.resize(vertices_count);
+  vertex_depths_.resize(vertices_count);
+  depth_offsets_.reserve(graph.get_depth() + 2);
+  depth_offsets_.push_back(0);
+  offsets_.reserve(vertices_count + 1);
+  offsets_.push_back(0);
+  // Петля записана в вершине один раз, остальные ребра - в обоих концах
+  neighbor_ids_.reserve(2 * edges_count);
+  edge_ids_.reserve(2 * edges_count);
+  colors_.reserve(2 * edges_count);
+  // (id соседа, id ребра) одной строки
+  std::vector<std::pair<VertexId, EdgeId>> row;
+  for (Depth depth = 0; depth <= graph.get_depth(); ++depth) {
+    for (const auto& vertex_id : graph.get_vertices_at_depth(depth)) {
+      assert(vertex_id < vertices_count && "Vertex ids must be sequential");
+      const auto& vertex = graph.get_vertex(vertex_id);
+      vertex_indices_[vertex_id] = vertex_ids_.size();
+      vertex_depths_[vertex_id] = vertex.depth;
+      vertex_ids_.push_back(vertex_id);
+      row.clear();
+      for (const auto& neighbor : vertex.get_neighbors()) {
+        row.emplace_back(neighbor.vertex_id, neighbor.edge_id);
+      }
+      std::sort(row.begin(), row.end());
+      for (const auto& [neighbor_id, edge_id] : row) {
+        neighbor_ids_.push_back(neighbor_id);
+        edge_ids_.push_back(edge_id);
+        colors_.push_back(edge_colors_[edge_id]);
+      }
+      offsets_.push_back(neighbor_ids_.size());
+    }
+    depth_offsets_.push_back(vertex_ids_.size());
+  }
+}
+
+bool FrozenGraph::check_binding(const VertexId& from_vertex_id,
+                                const VertexId& to_vertex_id) const {
+  const bool is_from_smaller =
+      get_degree(from_vertex_id) <= get_degree(to_vertex_id);
+  const VertexId& vertex_id = is_from_smaller ? from_vertex_id : to_vertex_id;
+  const VertexId& neighbor_id = is_from_smaller ? to_vertex_id : from_vertex_id;
+  const int vertex_idx = vertex_indices_[vertex_id];
+  return std::binary_search(neighbor_ids_.begin() + offsets_[vertex_idx],
+                            neighbor_ids_.begin() + offsets_[vertex_idx + 1],
+                            neighbor_id);
+}
+
+template <typename Storage>
+FrozenGraph BasicGraph<Storage>::freeze() const {
+  return FrozenGraph(*this);
+}
+
+template FrozenGraph::FrozenGraph(const Graph& graph);
+template FrozenGraph::FrozenGraph(const HashGraph& graph);
+template FrozenGraph Graph::freeze() const;
+template FrozenGraph HashGraph::freeze() const;
+
+}  // namespace uni_cpp_practice
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+#include "generation_policy.hpp"
+#include "graph.hpp"
+
+namespace uni_cpp_practice {
+
+// Неизменяемый снимок готового графа в формате CSR (compressed sparse row)
+// для тех, кто граф только читает. Вершины идут по возрастанию глубины,
+// соседи строки vertex_idx - [offsets[vertex_idx], offsets[vertex_idx + 1])
+// в плоских массивах neighbor_ids, edge_ids и colors, внутри строки -
+// по возрастанию id соседа. Петля записана в строке один раз.
+// Строится Graph::freeze за O(V + E log(степени)), после этого граф
+// можно менять: снимок от него не зависит.
+class FrozenGraph {
+ public:
+  // Определен для хранилищ, с которыми инстанцирован BasicGraph
+  template <typename Storage>
+  explicit FrozenGraph(const BasicGraph<Storage>& graph);
+
+  Depth get_depth() const { return depth_offsets_.size() - 2; }
+  int count_vertices() const { return vertex_ids_.size(); }
+  int count_edges() const { return edge_colors_.size(); }
+  int count_edges_of_color(const Edge::Color& color) const {
+    return edges_of_color_[int(color)];
+  }
+  int count_vertices_at_depth(const Depth& depth) const {
+    return depth_offsets_[depth + 1] - depth_offsets_[depth];
+  }
+
+  // Id вершин по возрастанию глубины, внутри уровня - в порядке
+  // Graph::get_vertices_at_depth
+  const std::vector<VertexId>& get_vertex_ids() const { return vertex_ids_; }
+  Depth get_vertex_depth(const VertexId& vertex_id) const {
+    return vertex_depths_[vertex_id];
+  }
+  int get_degree(const VertexId& vertex_id) const {
+    const int vertex_idx = vertex_indices_[vertex_id];
+    return offsets_[vertex_idx + 1] - offsets_[vertex_idx];
+  }
+
+  std::pair<VertexId, VertexId> get_edge_vertices(const EdgeId& edge_id) const {
+    return edge_vertex_ids_[edge_id];
+  }
+  const Edge::Color& get_edge_color(const EdgeId& edge_id) const {
+    return edge_colors_[edge_id];
+  }
+
+  // Вызывает callback(neighbor_id, edge_id, color) для соседей вершины
+  // по возрастанию их id
+  template <typename Callback>
+  void for_each_neighbor(const VertexId& vertex_id,
+                         const Callback& callback) const {
+    const int vertex_idx = vertex_indices_[vertex_id];
+    for (int idx = offsets_[vertex_idx]; idx < offsets_[vertex_idx + 1];
+         ++idx) {
+      callback(neighbor_ids_[idx], edge_ids_[idx], colors_[idx]);
+    }
+  }
+
+  // Двоичный поиск в строке вершины с меньшей степенью
+  bool check_binding(const VertexId& from_vertex_id,
+                     const VertexId& to_vertex_id) const;
+
+  // Плоские массивы CSR для обхода без обращения по id
+  const std::vector<int>& get_offsets() const { return offsets_; }
+  const std::vector<VertexId>& get_neighbor_ids() const {
+    return neighbor_ids_;
+  }
+  const std::vector<EdgeId>& get_edge_ids() const { return edge_ids_; }
+  const std::vector<Edge::Color>& get_colors() const { return colors_; }
+
+ private:
+  // Начала уровней в vertex_ids_, последний элемент - число вершин
+  std::vector<int> depth_offsets_;
+  std::vector<VertexId> vertex_ids_;
+  // Номер строки и глубина по id вершины: id выдаются подряд с нуля
+  std::vector<int> vertex_indices_;
+  std::vector<Depth> vertex_depths_;
+  std::vector<int> offsets_;
+  std::vector<VertexId> neighbor_ids_;
+  std::vector<EdgeId> edge_ids_;
+  std::vector<Edge::Color> colors_;
+  // Концы и цвет по id ребра: id тоже выдаются подряд с нуля
+  std::vector<std::pair<VertexId, VertexId>> edge_vertex_ids_;
+  std::vector<Edge::Color> edge_colors_;
+  std::array<int, COLORS_COUNT> edges_of_color_ = {};
+};
+
+}  // namespace uni_cpp_practice
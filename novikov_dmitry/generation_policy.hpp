@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include "graph.hpp"
+
+namespace uni_cpp_practice {
+
+// Политика генерации задает вероятности цветов ребер, цвет с нулевой
+// вероятностью выключен и его проход не выполняется. Вероятность серого
+// цвета - вероятность ребенка на нулевой глубине.
+// В DefaultPolicy все известно при компиляции: выключенные проходы
+// выбрасываются, а пороги в циклах становятся константами.
+struct DefaultPolicy {
+  static constexpr float get_color_probability(const Edge::Color& color) {
+    switch (color) {
+      case Edge::Color::Gray:
+        return 1.0;
+      case Edge::Color::Green:
+        return 0.1;
+      case Edge::Color::Blue:
+        return 0.25;
+      case Edge::Color::Yellow:
+        return 1.0;
+      case Edge::Color::Red:
+        return 0.33;
+    }
+    return 0;
+  }
+
+  static constexpr bool is_color_enabled(const Edge::Color& color) {
+    return get_color_probability(color) > 0;
+  }
+};
+
+// Вероятности задаются при запуске - для разовых экспериментов,
+// по умолчанию такие же, как в DefaultPolicy
+class RuntimePolicy {
+ public:
+  RuntimePolicy() {
+    for (int color = 0; color < COLORS_COUNT; ++color) {
+      color_probabilities_[color] =
+          DefaultPolicy::get_color_probability(Edge::Color(color));
+    }
+  }
+
+  void set_color_probability(const Edge::Color& color, float probability) {
+    assert(probability >= 0 && probability <= 1 &&
+           "given probability is incorrect");
+    color_probabilities_[int(color)] = probability;
+  }
+
+  float get_color_probability(const Edge::Color& color) const {
+    return color_probabilities_[int(color)];
+  }
+
+  bool is_color_enabled(const Edge::Color& color) const {
+    return get_color_probability(color) > 0;
+  }
+
+ private:
+  std::array<float, COLORS_COUNT> color_probabilities_ = {};
+};
+
+}  // namespace uni_cpp_practice
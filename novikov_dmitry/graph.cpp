@@ -1,204 +1,526 @@
-#include "graph.hpp"
-#include <cassert>
-#include <iterator>
-
-namespace {
-using Vertex = uni_cpp_practice::Vertex;
-using Edge = uni_cpp_practice::Edge;
-bool check_gray_valid(const Vertex& first_vertex, const Vertex& second_vertex) {
-  if (first_vertex.get_edge_ids().size() == 0 ||
-      second_vertex.get_edge_ids().size() == 0) {  //только текущее ребро
-    return true;
-  }
-  return false;
-}
-
-bool check_green_valid(const Vertex& first_vertex,
-                       const Vertex& second_vertex) {
-  if (first_vertex.id == second_vertex.id) {
-    return true;
-  }
-  return false;
-}
-
-bool check_blue_valid(const Vertex& first_vertex, const Vertex& second_vertex) {
-  if (first_vertex.depth == second_vertex.depth) {
-    return true;
-  }
-  return false;
-}
-
-bool check_yellow_valid(const Vertex& first_vertex,
-                        const Vertex& second_vertex) {
-  if (std::abs(first_vertex.depth - second_vertex.depth) == 1) {
-    return true;
-  }
-  return false;
-}
-
-bool check_red_valid(const Vertex& first_vertex, const Vertex& second_vertex) {
-  if (std::abs(first_vertex.depth - second_vertex.depth) == 2) {
-    return true;
-  }
-  return false;
-}
-
-bool check_color_valid(const Vertex& first_vertex,
-                       const Vertex& second_vertex,
-                       const Edge::Color& color) {
-  switch (color) {
-    case Edge::Color::Gray:
-      return check_gray_valid(first_vertex, second_vertex);
-    case Edge::Color::Green:
-      return check_green_valid(first_vertex, second_vertex);
-    case Edge::Color::Blue:
-      return check_blue_valid(first_vertex, second_vertex);
-    case Edge::Color::Yellow:
-      return check_yellow_valid(first_vertex, second_vertex);
-    case Edge::Color::Red:
-      return check_red_valid(first_vertex, second_vertex);
-  }
-}
-}  // namespace
-
-namespace uni_cpp_practice {
-bool Vertex::has_edge_id(const EdgeId& new_edge_id) const {
-  if (std::find(edge_ids_.begin(), edge_ids_.end(), new_edge_id) !=
-      edge_ids_.end()) {
-    return true;
-  }
-  return false;
-}
-
-void Vertex::add_edge_id(const EdgeId& new_edge_id) {
-  assert(!has_edge_id(new_edge_id) && "Edge id already exists");
-  edge_ids_.push_back(new_edge_id);
-}
-
-std::string color_to_string(const Edge::Color& color) {
-  switch (color) {
-    case Edge::Color::Gray:
-      return "gray";
-    case Edge::Color::Green:
-      return "green";
-    case Edge::Color::Blue:
-      return "blue";
-    case Edge::Color::Yellow:
-      return "yellow";
-    case Edge::Color::Red:
-      return "red";
-  }
-}
-
-VertexId Graph::add_vertex() {
-  const auto new_vertex_id = get_default_vertex_id();
-  vertex_map_.insert({new_vertex_id, Vertex(new_vertex_id)});
-  get_mutable_vertices_at_depth(DEFAULT_DEPTH).push_back(new_vertex_id);
-  return new_vertex_id;
-}
-
-void Graph::add_edge(const VertexId& from_vertex_id,
-                     const VertexId& to_vertex_id,
-                     const Edge::Color& new_edge_color) {
-  assert(has_vertex(from_vertex_id) && "Vertex doesn't exists");
-  assert(has_vertex(to_vertex_id) && "Vertex doesn't exists");
-  assert(!check_binding(from_vertex_id, to_vertex_id) &&
-         "Vertices already binded");
-  assert(check_color_valid(get_vertex(from_vertex_id), get_vertex(to_vertex_id),
-                           new_edge_color) &&
-         "Not valid color");
-  const auto new_edge_id = get_default_edge_id();
-  const auto new_edge =
-      edge_map_.insert({new_edge_id, Edge(from_vertex_id, to_vertex_id,
-                                          new_edge_id, new_edge_color)});
-  get_mutable_vertex(from_vertex_id).add_edge_id(new_edge.first->first);
-  if (from_vertex_id != to_vertex_id) {
-    get_mutable_vertex(to_vertex_id).add_edge_id(new_edge.first->first);
-  }
-  if (new_edge_color == Edge::Color::Gray) {
-    set_vertex_depth(from_vertex_id, to_vertex_id);
-  }
-}
-
-bool Graph::check_binding(const VertexId& from_vertex_id,
-                          const VertexId& to_vertex_id) const {
-  assert(has_vertex(from_vertex_id) && "Vertex doesn't exists");
-  assert(has_vertex(to_vertex_id) && "Vertex doesn't exists");
-  const auto& from_vertex = get_vertex(from_vertex_id);
-  const auto& to_vertex = get_vertex(to_vertex_id);
-  if (from_vertex_id == to_vertex_id) {
-    for (const auto& from_vertex_edge_id : from_vertex.get_edge_ids()) {
-      const auto& binded_vertices =
-          get_edge(from_vertex_edge_id).get_binded_vertices();
-      if (binded_vertices.first == binded_vertices.second) {
-        return true;
-      }
-    }
-  } else {
-    for (const auto& from_vertex_edge_id : from_vertex.get_edge_ids()) {
-      if (to_vertex.has_edge_id(from_vertex_edge_id)) {
-        return true;
-      }
-    }
-  }
-  return false;
-}
-
-int Graph::count_edges_of_color(const Edge::Color& color) const {
-  int count = 0;
-  for (const auto& [edge_id, edge] : get_edge_map()) {
-    if (edge.color == color) {
-      ++count;
-    }
-  }
-  return count;
-}
-
-Depth Graph::get_depth() const {
-  return (depth_map_.size() > DEFAULT_DEPTH) ? (depth_map_.size() - 1)
-                                             : DEFAULT_DEPTH;
-}
-
-const std::vector<VertexId>& Graph::get_vertices_at_depth(
-    const Depth& depth) const {
-  assert(depth <= get_depth() && "Depth level doesn't exist");
-  return depth_map_.at(depth);
-}
-
-const Vertex& Graph::get_vertex(const VertexId& id) const {
-  assert(has_vertex(id) && "Vertex doesn't exist");
-  return vertex_map_.at(id);
-}
-
-const Edge& Graph::get_edge(const EdgeId& id) const {
-  assert(has_edge(id) && "Edge doesn't exist");
-  return edge_map_.at(id);
-}
-
-void Graph::set_vertex_depth(const VertexId& from_vertex_id,
-                             const VertexId& to_vertex_id) {
-  assert(has_vertex(from_vertex_id) && "Vertex doesn't exists");
-  assert(has_vertex(to_vertex_id) && "Vertex doesn't exists");
-  assert(check_binding(from_vertex_id, to_vertex_id) &&
-         "Vertices already binded");
-  VertexId parent_vertex_id = std::min(from_vertex_id, to_vertex_id);
-  VertexId son_vertex_id = std::max(from_vertex_id, to_vertex_id);
-
-  const auto new_son_vertex_depth = get_vertex(parent_vertex_id).depth + 1;
-
-  auto& son_vertex = get_mutable_vertex(son_vertex_id);
-  auto& depth_map_son_level = get_mutable_vertices_at_depth(son_vertex.depth);
-
-  const auto vertex_iter_at_depth_map = std::remove(
-      depth_map_son_level.begin(), depth_map_son_level.end(), son_vertex.id);
-  depth_map_son_level.erase(vertex_iter_at_depth_map);
-  son_vertex.depth = new_son_vertex_depth;
-
-  if (depth_map_.size() <= new_son_vertex_depth) {
-    depth_map_.push_back(std::vector<VertexId>({son_vertex.id}));
-  } else {
-    get_mutable_vertices_at_depth(new_son_vertex_depth)
-        .push_back(son_vertex.id);
-  }
-}
-}  // namespace uni_cpp_practice
+#include "graph.hpp"
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace {
+using Vertex = uni_cpp_practice::Vertex;
+using Edge = uni_cpp_practice::Edge;
+
+constexpr int MIN_VERTEX_PAIR_SLOTS_COUNT = 16;
+constexpr int MAX_THREADS_COUNT = 4;
+// Уровни меньше этого размера дешевле добавить в одном потоке
+constexpr int MIN_PARALLEL_LAYER_SIZE = 4096;
+// 2^64 / золотое сечение: мультипликативное хеширование Фибоначчи
+constexpr std::uint64_t VERTEX_PAIR_HASH_MULTIPLIER = 0x9E3779B97F4A7C15;
+
+// Место под count новых элементов. Растем геометрически: reserve(size + count)
+// на каждую маленькую группу перевыделял бы память каждый раз
+template <typename T, typename Allocator>
+void reserve_more(std::vector<T, Allocator>& container, int count) {
+  const auto required_size = container.size() + count;
+  if (required_size > container.capacity()) {
+    container.reserve(std::max(required_size, 2 * container.capacity()));
+  }
+}
+
+template <typename Key, typename Value>
+void reserve_more(uni_cpp_practice::DenseIdMap<Key, Value>& container,
+                  int count) {
+  const auto required_size = container.size() + count;
+  if (required_size > container.capacity()) {
+    container.reserve(std::max(required_size, 2 * container.capacity()));
+  }
+}
+
+template <typename Key, typename Value>
+void reserve_more(std::pmr::unordered_map<Key, Value>& container,
+                  int count) {
+  const auto required_size = container.size() + count;
+  if (required_size > container.bucket_count() * container.max_load_factor()) {
+    container.reserve(std::max(required_size, 2 * container.size()));
+  }
+}
+
+// Добавляет значение с новым id, возвращает ссылку на него в таблице
+template <typename Key, typename Value>
+Value& insert_value(uni_cpp_practice::DenseIdMap<Key, Value>& container,
+                    const Key& key,
+                    Value&& value) {
+  return container.insert(key, std::move(value));
+}
+
+template <typename Key, typename Value>
+Value& insert_value(std::pmr::unordered_map<Key, Value>& container,
+                    const Key& key,
+                    Value&& value) {
+  return container.insert({key, std::move(value)}).first->second;
+}
+
+// Делит [0, parent_vertex_ids.size()) на MAX_THREADS_COUNT кусков и
+// вызывает callback(first_idx, last_idx) для каждого в своем потоке.
+// Граница куска сдвигается к началу группы детей одного родителя, чтобы
+// список соседей каждого родителя менял только один поток.
+template <typename Callback>
+void for_each_parents_chunk(
+    uni_cpp_practice::VertexIdSpan parent_vertex_ids,
+    const Callback& callback) {
+  const int size = parent_vertex_ids.size();
+  if (size < MIN_PARALLEL_LAYER_SIZE) {
+    callback(0, size);
+    return;
+  }
+  std::array<int, MAX_THREADS_COUNT + 1> chunk_begins = {};
+  for (int i = 1; i < MAX_THREADS_COUNT; ++i) {
+    int chunk_begin = std::max<int>(chunk_begins[i - 1],
+                                    std::int64_t(size) * i / MAX_THREADS_COUNT);
+    while (0 < chunk_begin && chunk_begin < size &&
+           parent_vertex_ids[chunk_begin] ==
+               parent_vertex_ids[chunk_begin - 1]) {
+      ++chunk_begin;
+    }
+    chunk_begins[i] = chunk_begin;
+  }
+  chunk_begins[MAX_THREADS_COUNT] = size;
+  std::array<std::thread, MAX_THREADS_COUNT> threads;
+  for (int i = 0; i < MAX_THREADS_COUNT; ++i) {
+    threads[i] = std::thread(callback, chunk_begins[i], chunk_begins[i + 1]);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+bool check_gray_valid(const Vertex& first_vertex, const Vertex& second_vertex) {
+  if (first_vertex.get_neighbors().size() == 0 ||
+      second_vertex.get_neighbors().size() == 0) {  //только текущее ребро
+    return true;
+  }
+  return false;
+}
+
+bool check_green_valid(const Vertex& first_vertex,
+                       const Vertex& second_vertex) {
+  if (first_vertex.id == second_vertex.id) {
+    return true;
+  }
+  return false;
+}
+
+bool check_blue_valid(const Vertex& first_vertex, const Vertex& second_vertex) {
+  if (first_vertex.depth == second_vertex.depth) {
+    return true;
+  }
+  return false;
+}
+
+bool check_yellow_valid(const Vertex& first_vertex,
+                        const Vertex& second_vertex) {
+  if (std::abs(first_vertex.depth - second_vertex.depth) == 1) {
+    return true;
+  }
+  return false;
+}
+
+bool check_red_valid(const Vertex& first_vertex, const Vertex& second_vertex) {
+  if (std::abs(first_vertex.depth - second_vertex.depth) == 2) {
+    return true;
+  }
+  return false;
+}
+
+bool check_color_valid(const Vertex& first_vertex,
+                       const Vertex& second_vertex,
+                       const Edge::Color& color) {
+  switch (color) {
+    case Edge::Color::Gray:
+      return check_gray_valid(first_vertex, second_vertex);
+    case Edge::Color::Green:
+      return check_green_valid(first_vertex, second_vertex);
+    case Edge::Color::Blue:
+      return check_blue_valid(first_vertex, second_vertex);
+    case Edge::Color::Yellow:
+      return check_yellow_valid(first_vertex, second_vertex);
+    case Edge::Color::Red:
+      return check_red_valid(first_vertex, second_vertex);
+  }
+}
+}  // namespace
+
+namespace uni_cpp_practice {
+bool Vertex::has_edge_id(const EdgeId& new_edge_id) const {
+  return std::any_of(neighbors_.begin(), neighbors_.end(),
+                     [&new_edge_id](const Neighbor& neighbor) {
+                       return neighbor.edge_id == new_edge_id;
+                     });
+}
+
+std::string color_to_string(const Edge::Color& color) {
+  switch (color) {
+    case Edge::Color::Gray:
+      return "gray";
+    case Edge::Color::Green:
+      return "green";
+    case Edge::Color::Blue:
+      return "blue";
+    case Edge::Color::Yellow:
+      return "yellow";
+    case Edge::Color::Red:
+      return "red";
+  }
+}
+
+void VertexPairIndex::reserve(int edges_count) {
+  if (2 * edges_count > int(slots_.size())) {
+    rehash(2 * edges_count);
+  }
+}
+
+void VertexPairIndex::insert(const VertexId& first_vertex_id,
+                             const VertexId& second_vertex_id,
+                             const EdgeId& edge_id) {
+  if (2 * (size_ + 1) > int(slots_.size())) {
+    rehash(std::max(MIN_VERTEX_PAIR_SLOTS_COUNT, 2 * int(slots_.size())));
+  }
+  const auto [min_vertex_id, max_vertex_id] =
+      std::minmax(first_vertex_id, second_vertex_id);
+  for (int idx = get_first_slot_idx(min_vertex_id, max_vertex_id);;
+       idx = get_next_slot_idx(idx)) {
+    auto& slot = slots_[idx];
+    if (slot.edge_id == NO_EDGE) {
+      slot = {min_vertex_id, max_vertex_id, edge_id};
+      ++size_;
+      return;
+    }
+    if (slot.min_vertex_id == min_vertex_id &&
+        slot.max_vertex_id == max_vertex_id) {
+      return;
+    }
+  }
+}
+
+std::optional<EdgeId> VertexPairIndex::find(
+    const VertexId& first_vertex_id,
+    const VertexId& second_vertex_id) const {
+  if (size_ == 0) {
+    return std::nullopt;
+  }
+  const auto [min_vertex_id, max_vertex_id] =
+      std::minmax(first_vertex_id, second_vertex_id);
+  for (int idx = get_first_slot_idx(min_vertex_id, max_vertex_id);;
+       idx = get_next_slot_idx(idx)) {
+    const auto& slot = slots_[idx];
+    if (slot.edge_id == NO_EDGE) {
+      return std::nullopt;
+    }
+    if (slot.min_vertex_id == min_vertex_id &&
+        slot.max_vertex_id == max_vertex_id) {
+      return slot.edge_id;
+    }
+  }
+}
+
+int VertexPairIndex::get_first_slot_idx(const VertexId& min_vertex_id,
+                                        const VertexId& max_vertex_id) const {
+  // Число слотов - не степень двойки, поэтому старшие 32 бита хеша
+  // переводятся в [0, slots_count) умножением, а не маской
+  const std::uint64_t slots_count = slots_.size();
+  const auto offset =
+      (((std::uint64_t(min_vertex_id) * VERTEX_PAIR_HASH_MULTIPLIER) >> 32) *
+       slots_count) >>
+      32;
+  // Слотов больше, чем ребер, поэтому обычно и больше, чем вершин
+  std::uint64_t max_vertex_offset = max_vertex_id;
+  if (max_vertex_offset >= slots_count) {
+    max_vertex_offset %= slots_count;
+  }
+  const auto idx = offset + max_vertex_offset;
+  return idx < slots_count ? idx : idx - slots_count;
+}
+
+void VertexPairIndex::rehash(int slots_count) {
+  auto old_slots = std::move(slots_);
+  slots_.assign(slots_count, Slot());
+  for (const auto& old_slot : old_slots) {
+    if (old_slot.edge_id == NO_EDGE) {
+      continue;
+    }
+    int idx =
+        get_first_slot_idx(old_slot.min_vertex_id, old_slot.max_vertex_id);
+    while (slots_[idx].edge_id != NO_EDGE) {
+      idx = get_next_slot_idx(idx);
+    }
+    slots_[idx] = old_slot;
+  }
+}
+
+template <typename Storage>
+void BasicGraph<Storage>::reserve(int vertices_count,
+                                  int edges_count,
+                                  const Depth& depth) {
+  vertex_map_.reserve(vertices_count);
+  edge_map_.reserve(edges_count);
+  vertex_pair_index_.reserve(edges_count);
+  depth_map_.reserve(depth + 1);
+}
+
+template <typename Storage>
+VertexId BasicGraph<Storage>::add_vertex() {
+  const auto new_vertex_id = get_default_vertex_id();
+  insert_value(vertex_map_, new_vertex_id, Vertex(new_vertex_id));
+  get_mutable_vertices_at_depth(DEFAULT_DEPTH).push_back(new_vertex_id);
+  return new_vertex_id;
+}
+
+template <typename Storage>
+VertexId BasicGraph<Storage>::add_children(const VertexId& parent_vertex_id,
+                                           int count) {
+  assert(count >= 0 && "Children count can't be negative");
+  auto& depth_map_child_level = get_mutable_child_level(parent_vertex_id);
+  reserve_more(vertex_map_, count);
+  reserve_more(edge_map_, count);
+  reserve_more(depth_map_child_level, count);
+  auto& parent_vertex = get_mutable_vertex(parent_vertex_id);
+  parent_vertex.reserve_neighbors(
+      parent_vertex.get_neighbors().size() + count, get_memory_resource());
+
+  const VertexId first_child_id = default_vertex_id_;
+  for (int i = 0; i < count; ++i) {
+    add_child(parent_vertex_id, depth_map_child_level);
+  }
+  return first_child_id;
+}
+
+template <typename Storage>
+VertexId BasicGraph<Storage>::add_layer(VertexIdSpan parent_vertex_ids) {
+  const VertexId first_child_id = default_vertex_id_;
+  if (parent_vertex_ids.empty()) {
+    return first_child_id;
+  }
+  const int count = parent_vertex_ids.size();
+  auto& depth_map_child_level =
+      get_mutable_child_level(parent_vertex_ids.front());
+  reserve_more(vertex_map_, count);
+  reserve_more(edge_map_, count);
+  reserve_more(depth_map_child_level, count);
+  if constexpr (!std::is_same_v<Storage, DenseGraphStorage>) {
+    for (const auto& parent_vertex_id : parent_vertex_ids) {
+      assert(get_vertex(parent_vertex_id).depth ==
+                 get_vertex(parent_vertex_ids.front()).depth &&
+             "Parents must be at the same depth");
+      add_child(parent_vertex_id, depth_map_child_level);
+    }
+    return first_child_id;
+  } else {
+    const EdgeId first_edge_id = default_edge_id_;
+    const Depth child_depth = get_vertex(parent_vertex_ids.front()).depth + 1;
+    const int first_level_idx = depth_map_child_level.size();
+    depth_map_child_level.resize(first_level_idx + count);
+    // Место под детей в списках соседей родителей выделяется заранее
+    // в одном потоке: ресурс графа может быть непотокобезопасной ареной
+    for (int group_begin = 0, group_end = 0; group_begin < count;
+         group_begin = group_end) {
+      const VertexId parent_vertex_id = parent_vertex_ids[group_begin];
+      while (group_end < count &&
+             parent_vertex_ids[group_end] == parent_vertex_id) {
+        ++group_end;
+      }
+      auto& parent_vertex = get_mutable_vertex(parent_vertex_id);
+      assert(parent_vertex.depth + 1 == child_depth &&
+             "Parents must be at the same depth");
+      parent_vertex.reserve_neighbors(
+          parent_vertex.get_neighbors().size() + group_end - group_begin,
+          get_memory_resource());
+    }
+
+    // Ребенок idx получает id first_child_id + idx и ребро
+    // first_edge_id + idx, так что куски не зависят друг от друга
+    for_each_parents_chunk(
+        parent_vertex_ids,
+        [this, &parent_vertex_ids, &depth_map_child_level, first_child_id,
+         first_edge_id, child_depth, first_level_idx](int first_idx,
+                                                      int last_idx) {
+          for (int idx = first_idx; idx < last_idx; ++idx) {
+            const VertexId parent_vertex_id = parent_vertex_ids[idx];
+            const VertexId child_id = first_child_id + idx;
+            const EdgeId edge_id = first_edge_id + idx;
+            auto& child_vertex =
+                vertex_map_.construct_at(child_id, Vertex(child_id));
+            child_vertex.depth = child_depth;
+            child_vertex.add_neighbor(parent_vertex_id, edge_id,
+                                      Edge::Color::Gray,
+                                      get_memory_resource());
+            edge_map_.construct_at(edge_id,
+                                   Edge(parent_vertex_id, child_id, edge_id,
+                                        Edge::Color::Gray));
+            get_mutable_vertex(parent_vertex_id)
+                .add_neighbor(child_id, edge_id, Edge::Color::Gray,
+                              get_memory_resource());
+            depth_map_child_level[first_level_idx + idx] = child_id;
+          }
+        });
+    vertex_map_.set_constructed_size(first_child_id + count);
+    edge_map_.set_constructed_size(first_edge_id + count);
+    default_vertex_id_ += count;
+    default_edge_id_ += count;
+    edges_of_color_counts_[int(Edge::Color::Gray)] += count;
+
+    for (int idx = 0; idx < count; ++idx) {
+      vertex_pair_index_.insert(parent_vertex_ids[idx], first_child_id + idx,
+                                first_edge_id + idx);
+    }
+    return first_child_id;
+  }
+}
+
+template <typename Storage>
+void BasicGraph<Storage>::add_edge(const VertexId& from_vertex_id,
+                                   const VertexId& to_vertex_id,
+                                   const Edge::Color& new_edge_color) {
+  if (validation_mode_ != ValidationMode::Off) {
+    if (!has_vertex(from_vertex_id) || !has_vertex(to_vertex_id)) {
+      throw std::runtime_error("Vertex doesn't exist: " +
+                               std::to_string(from_vertex_id) + " -> " +
+                               std::to_string(to_vertex_id));
+    }
+    // Повторное ребро ищется по VertexPairIndex за O(1)
+    if (vertex_pair_index_.find(from_vertex_id, to_vertex_id)) {
+      throw std::runtime_error("Vertices already binded: " +
+                               std::to_string(from_vertex_id) + " -> " +
+                               std::to_string(to_vertex_id));
+    }
+    if (!check_color_valid(get_vertex(from_vertex_id),
+                           get_vertex(to_vertex_id), new_edge_color)) {
+      throw std::runtime_error("Not valid color " +
+                               color_to_string(new_edge_color) + ": " +
+                               std::to_string(from_vertex_id) + " -> " +
+                               std::to_string(to_vertex_id));
+    }
+  }
+  const auto new_edge_id = get_default_edge_id();
+  insert_value(edge_map_, new_edge_id,
+               Edge(from_vertex_id, to_vertex_id, new_edge_id,
+                    new_edge_color));
+  ++edges_of_color_counts_[int(new_edge_color)];
+  get_mutable_vertex(from_vertex_id)
+      .add_neighbor(to_vertex_id, new_edge_id, new_edge_color,
+                    get_memory_resource());
+  vertex_pair_index_.insert(from_vertex_id, to_vertex_id, new_edge_id);
+  if (from_vertex_id != to_vertex_id) {
+    get_mutable_vertex(to_vertex_id)
+        .add_neighbor(from_vertex_id, new_edge_id, new_edge_color,
+                      get_memory_resource());
+  }
+  if (new_edge_color == Edge::Color::Gray) {
+    set_vertex_depth(from_vertex_id, to_vertex_id);
+  }
+}
+
+template <typename Storage>
+bool BasicGraph<Storage>::check_binding(const VertexId& from_vertex_id,
+                                        const VertexId& to_vertex_id) const {
+  return find_edge_id(from_vertex_id, to_vertex_id).has_value();
+}
+
+template <typename Storage>
+std::optional<EdgeId> BasicGraph<Storage>::find_edge_id(
+    const VertexId& from_vertex_id,
+    const VertexId& to_vertex_id) const {
+  assert(has_vertex(from_vertex_id) && "Vertex doesn't exists");
+  assert(has_vertex(to_vertex_id) && "Vertex doesn't exists");
+  return vertex_pair_index_.find(from_vertex_id, to_vertex_id);
+}
+
+template <typename Storage>
+Depth BasicGraph<Storage>::get_depth() const {
+  return (depth_map_.size() > DEFAULT_DEPTH) ? (depth_map_.size() - 1)
+                                             : DEFAULT_DEPTH;
+}
+
+template <typename Storage>
+VertexIdSpan BasicGraph<Storage>::get_vertices_at_depth(
+    const Depth& depth) const {
+  assert(depth <= get_depth() && "Depth level doesn't exist");
+  return depth_map_.at(depth);
+}
+
+template <typename Storage>
+const Vertex& BasicGraph<Storage>::get_vertex(const VertexId& id) const {
+  assert(has_vertex(id) && "Vertex doesn't exist");
+  return vertex_map_.at(id);
+}
+
+template <typename Storage>
+const Edge& BasicGraph<Storage>::get_edge(const EdgeId& id) const {
+  assert(has_edge(id) && "Edge doesn't exist");
+  return edge_map_.at(id);
+}
+
+template <typename Storage>
+VertexId BasicGraph<Storage>::add_child(
+    const VertexId& parent_vertex_id,
+    DepthLevel& depth_map_child_level) {
+  const auto child_id = get_default_vertex_id();
+  const auto edge_id = get_default_edge_id();
+  auto& child_vertex = insert_value(vertex_map_, child_id, Vertex(child_id));
+  child_vertex.depth = get_vertex(parent_vertex_id).depth + 1;
+  child_vertex.add_neighbor(parent_vertex_id, edge_id, Edge::Color::Gray,
+                            get_memory_resource());
+  insert_value(edge_map_, edge_id,
+               Edge(parent_vertex_id, child_id, edge_id, Edge::Color::Gray));
+  ++edges_of_color_counts_[int(Edge::Color::Gray)];
+  get_mutable_vertex(parent_vertex_id)
+      .add_neighbor(child_id, edge_id, Edge::Color::Gray,
+                    get_memory_resource());
+  vertex_pair_index_.insert(parent_vertex_id, child_id, edge_id);
+  depth_map_child_level.push_back(child_id);
+  return child_id;
+}
+
+template <typename Storage>
+typename BasicGraph<Storage>::DepthLevel&
+BasicGraph<Storage>::get_mutable_child_level(
+    const VertexId& parent_vertex_id) {
+  assert(has_vertex(parent_vertex_id) && "Vertex doesn't exists");
+  const auto child_depth = get_vertex(parent_vertex_id).depth + 1;
+  if (Depth(depth_map_.size()) <= child_depth) {
+    depth_map_.emplace_back();
+  }
+  return get_mutable_vertices_at_depth(child_depth);
+}
+
+template <typename Storage>
+void BasicGraph<Storage>::set_vertex_depth(const VertexId& from_vertex_id,
+                                           const VertexId& to_vertex_id) {
+  assert(has_vertex(from_vertex_id) && "Vertex doesn't exists");
+  assert(has_vertex(to_vertex_id) && "Vertex doesn't exists");
+  assert(check_binding(from_vertex_id, to_vertex_id) &&
+         "Vertices already binded");
+  VertexId parent_vertex_id = std::min(from_vertex_id, to_vertex_id);
+  VertexId son_vertex_id = std::max(from_vertex_id, to_vertex_id);
+
+  const auto new_son_vertex_depth = get_vertex(parent_vertex_id).depth + 1;
+
+  auto& son_vertex = get_mutable_vertex(son_vertex_id);
+  auto& depth_map_son_level = get_mutable_vertices_at_depth(son_vertex.depth);
+
+  const auto vertex_iter_at_depth_map = std::remove(
+      depth_map_son_level.begin(), depth_map_son_level.end(), son_vertex.id);
+  depth_map_son_level.erase(vertex_iter_at_depth_map);
+  son_vertex.depth = new_son_vertex_depth;
+
+  if (depth_map_.size() <= new_son_vertex_depth) {
+    depth_map_.emplace_back().push_back(son_vertex.id);
+  } else {
+    get_mutable_vertices_at_depth(new_son_vertex_depth)
+        .push_back(son_vertex.id);
+  }
+}
+
+template class BasicGraph<DenseGraphStorage>;
+template class BasicGraph<HashGraphStorage>;
+}  // namespace uni_cpp_practice
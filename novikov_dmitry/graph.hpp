@@ -1,124 +1,499 @@
-#pragma once
-
-#include <algorithm>
-#include <sstream>
-#include <string>
-#include <unordered_map>
-#include <vector>
-
-namespace uni_cpp_practice {
-constexpr int DEFAULT_DEPTH = 0;
-
-using VertexId = int;
-using EdgeId = int;
-using Depth = int;
-
-class Vertex {
- public:
-  Depth depth = 0;
-  const VertexId id = 0;
-
-  explicit Vertex(const VertexId& new_vertex_id) : id(new_vertex_id) {}
-
-  void add_edge_id(const EdgeId& new_edge_id);
-
-  bool has_edge_id(const EdgeId& new_edge_id) const;
-
-  const std::vector<EdgeId>& get_edge_ids() const { return edge_ids_; }
-
- private:
-  std::vector<EdgeId> edge_ids_;
-};
-
-class Edge {
- public:
-  enum class Color { Gray, Green, Blue, Yellow, Red };
-
-  const Color color;
-
-  Edge(const VertexId& from_vertex_id,
-       const VertexId& to_vertex_id,
-       const EdgeId& new_edge_id,
-       const Color& new_edge_color)
-      : color(new_edge_color),
-        ver_id1_(from_vertex_id),
-        ver_id2_(to_vertex_id),
-        id_(new_edge_id) {}
-
-  std::pair<VertexId, VertexId> get_binded_vertices() const {
-    return {ver_id1_, ver_id2_};
-  }
-
-  const EdgeId& get_id() const { return id_; }
-
- private:
-  const VertexId ver_id1_ = 0;
-  const VertexId ver_id2_ = 0;
-  const EdgeId id_ = 0;
-};
-
-std::string color_to_string(const Edge::Color& color);
-
-class Graph {
- public:
-  VertexId add_vertex();
-
-  void add_edge(const VertexId& from_vertex_id,
-                const VertexId& to_vertex_id,
-                const Edge::Color& new_edge_color = Edge::Color::Gray);
-
-  bool check_binding(const VertexId& from_vertex_id,
-                     const VertexId& to_vertex_id) const;
-
-  bool has_vertex(const VertexId& id) const {
-    return vertex_map_.find(id) != vertex_map_.end();
-  }
-
-  bool has_edge(const EdgeId& id) const {
-    return edge_map_.find(id) != edge_map_.end();
-  }
-
-  const std::unordered_map<VertexId, Vertex>& get_vertex_map() const {
-    return vertex_map_;
-  }
-  const std::unordered_map<EdgeId, Edge>& get_edge_map() const {
-    return edge_map_;
-  }
-
-  int count_edges_of_color(const Edge::Color& color) const;
-
-  Depth get_depth() const;
-
-  const std::vector<VertexId>& get_vertices_at_depth(const Depth& depth) const;
-
-  const Vertex& get_vertex(const VertexId& id) const;
-
-  const Edge& get_edge(const EdgeId& id) const;
-
- private:
-  VertexId default_vertex_id_ = 0;
-  EdgeId default_edge_id_ = 0;
-  std::unordered_map<VertexId, Vertex> vertex_map_;
-  std::unordered_map<EdgeId, Edge> edge_map_;
-  std::vector<std::vector<VertexId>> depth_map_ = {{}};
-
-  VertexId get_default_vertex_id() { return default_vertex_id_++; }
-
-  EdgeId get_default_edge_id() { return default_edge_id_++; }
-
-  Vertex& get_mutable_vertex(const VertexId& id) {
-    return const_cast<Vertex&>(get_vertex(id));
-  }
-
-  Edge& get_mutable_edge(const EdgeId& id) {
-    return const_cast<Edge&>(get_edge(id));
-  }
-
-  std::vector<VertexId>& get_mutable_vertices_at_depth(const Depth& depth) {
-    return const_cast<std::vector<VertexId>&>(get_vertices_at_depth(depth));
-  }
-
-  void set_vertex_depth(const VertexId& from_vertex_id,
-                        const VertexId& to_vertex_id);
-};
-}  // namespace uni_cpp_practice
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "small_vector.hpp"
+
+namespace uni_cpp_practice {
+constexpr int DEFAULT_DEPTH = 0;
+
+using VertexId = int;
+using EdgeId = int;
+using Depth = int;
+
+// Непрерывный ряд id только для чтения, как std::span из C++20: ссылается
+// на чужую память и действителен, пока она не изменится. Неявно строится
+// из std::vector и std::pmr::vector, поэтому функции, принимающие ряд id,
+// не зависят от аллокатора контейнера.
+class VertexIdSpan {
+ public:
+  VertexIdSpan() = default;
+  VertexIdSpan(const VertexId* data, int size) : data_(data), size_(size) {}
+  template <typename Allocator>
+  VertexIdSpan(const std::vector<VertexId, Allocator>& vertex_ids)
+      : data_(vertex_ids.data()), size_(vertex_ids.size()) {}
+
+  const VertexId* data() const { return data_; }
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const VertexId* begin() const { return data_; }
+  const VertexId* end() const { return data_ + size_; }
+  const VertexId& operator[](int idx) const { return data_[idx]; }
+  const VertexId& front() const { return data_[0]; }
+  const VertexId& back() const { return data_[size_ - 1]; }
+
+ private:
+  const VertexId* data_ = nullptr;
+  int size_ = 0;
+};
+
+// Проверки при построении графа, не зависят от NDEBUG:
+// Off - без проверок;
+// Cheap - add_edge за O(1) проверяет, что вершины есть, ребра между ними
+// еще нет и цвет допустим;
+// Full - как Cheap, и после генерации весь граф проверяется validate
+// (graph_validation.hpp).
+enum class ValidationMode { Off, Cheap, Full };
+
+class Edge {
+ public:
+  enum class Color { Gray, Green, Blue, Yellow, Red };
+
+  const Color color;
+
+  Edge(const VertexId& from_vertex_id,
+       const VertexId& to_vertex_id,
+       const EdgeId& new_edge_id,
+       const Color& new_edge_color)
+      : color(new_edge_color),
+        ver_id1_(from_vertex_id),
+        ver_id2_(to_vertex_id),
+        id_(new_edge_id) {}
+
+  std::pair<VertexId, VertexId> get_binded_vertices() const {
+    return {ver_id1_, ver_id2_};
+  }
+
+  const EdgeId& get_id() const { return id_; }
+
+ private:
+  const VertexId ver_id1_ = 0;
+  const VertexId ver_id2_ = 0;
+  const EdgeId id_ = 0;
+};
+
+constexpr std::size_t CACHE_LINE_BYTES = 64;
+
+// Число соседей, которые хранятся прямо в Vertex без выделения памяти:
+// средняя степень вершины сгенерированного графа - около 4.5, а Vertex
+// с четырьмя соседями занимает ровно кеш-линию. DenseIdMap хранит
+// вершины без ключей с началом на границе кеш-линии, поэтому каждая
+// вершина лежит в одной линии.
+constexpr int INLINE_NEIGHBORS_COUNT = 4;
+
+class Vertex {
+ public:
+  // Запись списка смежности: второй конец ребра (для петли - сама
+  // вершина), id ребра и его цвет, чтобы обход соседей не обращался
+  // к таблице ребер
+  struct Neighbor {
+    VertexId vertex_id;
+    EdgeId edge_id;
+    Edge::Color color;
+  };
+  using NeighborList = SmallVector<Neighbor, INLINE_NEIGHBORS_COUNT>;
+
+  Depth depth = 0;
+  const VertexId id = 0;
+
+  explicit Vertex(const VertexId& new_vertex_id) : id(new_vertex_id) {}
+
+  // Если соседи не помещаются в Vertex, память под них берется
+  // из memory_resource (обычно - ресурс графа)
+  void add_neighbor(const VertexId& neighbor_vertex_id,
+                    const EdgeId& new_edge_id,
+                    const Edge::Color& color,
+                    std::pmr::memory_resource* memory_resource =
+                        std::pmr::get_default_resource()) {
+    neighbors_.push_back({neighbor_vertex_id, new_edge_id, color},
+                         memory_resource);
+  }
+
+  void reserve_neighbors(int count,
+                         std::pmr::memory_resource* memory_resource =
+                             std::pmr::get_default_resource()) {
+    neighbors_.reserve(count, memory_resource);
+  }
+
+  bool has_edge_id(const EdgeId& new_edge_id) const;
+
+  // Соседи в порядке добавления ребер
+  const NeighborList& get_neighbors() const { return neighbors_; }
+
+ private:
+  NeighborList neighbors_;
+};
+
+static_assert(sizeof(Vertex) == CACHE_LINE_BYTES,
+              "Vertex with inline neighbors must fill one cache line");
+
+constexpr int COLORS_COUNT = 5;
+
+std::string color_to_string(const Edge::Color& color);
+
+// Таблица id -> значение для id, которые выдаются подряд с нуля: значения
+// лежат подряд в памяти из memory_resource, id - номер значения и сам
+// не хранится. Начало массива выровнено по кеш-линии. Повторяет нужную
+// Graph часть интерфейса std::pmr::unordered_map (find, at, обход пар
+// {id, значение}), но без хеширования и с обходом в порядке id; обход
+// выдает пары {id, ссылка на значение} по значению.
+template <typename Key, typename Value>
+class DenseIdMap {
+ public:
+  using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::pair<Key, const Value&>;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+    // operator-> отдает пару через временный объект
+    struct pointer {
+      value_type pair;
+      const value_type* operator->() const { return &pair; }
+    };
+
+    const_iterator(const Value* values, Key key)
+        : values_(values), key_(key) {}
+
+    reference operator*() const { return {key_, values_[key_]}; }
+    pointer operator->() const { return {**this}; }
+    const_iterator& operator++() {
+      ++key_;
+      return *this;
+    }
+    const_iterator operator+(Key offset) const {
+      return {values_, key_ + offset};
+    }
+    bool operator==(const const_iterator& other) const {
+      return key_ == other.key_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return key_ != other.key_;
+    }
+
+   private:
+    const Value* values_ = nullptr;
+    Key key_ = 0;
+  };
+
+  DenseIdMap() : DenseIdMap(std::pmr::get_default_resource()) {}
+  explicit DenseIdMap(const allocator_type& allocator)
+      : memory_resource_(allocator.resource()) {}
+  // Копия, как у std::pmr, лежит в ресурсе по умолчанию
+  DenseIdMap(const DenseIdMap& other) : DenseIdMap() {
+    reserve(other.size_);
+    for (; size_ < other.size_; ++size_) {
+      new (values_ + size_) Value(other.values_[size_]);
+    }
+  }
+  DenseIdMap(DenseIdMap&& other) noexcept
+      : memory_resource_(other.memory_resource_),
+        values_(std::exchange(other.values_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)) {}
+  DenseIdMap& operator=(DenseIdMap other) noexcept {
+    std::swap(memory_resource_, other.memory_resource_);
+    std::swap(values_, other.values_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    return *this;
+  }
+  ~DenseIdMap() { free_values(); }
+
+  allocator_type get_allocator() const { return memory_resource_; }
+
+  void reserve(int count);
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  int capacity() const { return capacity_; }
+
+  // Ключ должен быть следующим по порядку id
+  Value& insert(const Key& key, Value&& value) {
+    assert(key == size_ && "Dense ids must be sequential");
+    if (size_ == capacity_) {
+      reserve(std::max(1, 2 * capacity_));
+    }
+    return *new (values_ + size_++) Value(std::move(value));
+  }
+
+  // Создает значение с id key в уже выделенном месте за size(). Значения
+  // с разными id можно создавать из разных потоков; в таблицу они
+  // попадают, когда все id [size(), new_size) созданы и вызван
+  // set_constructed_size(new_size).
+  Value& construct_at(const Key& key, Value&& value) {
+    assert(size_ <= key && key < capacity_ && "Key must be reserved");
+    return *new (values_ + key) Value(std::move(value));
+  }
+  void set_constructed_size(int size) {
+    assert(size_ <= size && size <= capacity_);
+    size_ = size;
+  }
+
+  const_iterator find(const Key& key) const {
+    return 0 <= key && key < size_ ? begin() + key : end();
+  }
+  const Value& at(const Key& key) const {
+    if (key < 0 || key >= size_) {
+      throw std::out_of_range("DenseIdMap::at");
+    }
+    return values_[key];
+  }
+
+  const_iterator begin() const { return {values_, 0}; }
+  const_iterator end() const { return {values_, size_}; }
+
+ private:
+  static constexpr std::size_t VALUES_ALIGNMENT =
+      std::max(alignof(Value), CACHE_LINE_BYTES);
+
+  std::pmr::memory_resource* memory_resource_ = nullptr;
+  Value* values_ = nullptr;
+  int size_ = 0;
+  int capacity_ = 0;
+
+  void free_values();
+};
+
+template <typename Key, typename Value>
+void DenseIdMap<Key, Value>::reserve(int count) {
+  if (count <= capacity_) {
+    return;
+  }
+  auto* const values = static_cast<Value*>(memory_resource_->allocate(
+      count * sizeof(Value), VALUES_ALIGNMENT));
+  for (int idx = 0; idx < size_; ++idx) {
+    new (values + idx) Value(std::move(values_[idx]));
+  }
+  const int size = size_;
+  free_values();
+  values_ = values;
+  size_ = size;
+  capacity_ = count;
+}
+
+template <typename Key, typename Value>
+void DenseIdMap<Key, Value>::free_values() {
+  for (int idx = 0; idx < size_; ++idx) {
+    values_[idx].~Value();
+  }
+  if (values_ != nullptr) {
+    memory_resource_->deallocate(values_, capacity_ * sizeof(Value),
+                                 VALUES_ALIGNMENT);
+  }
+  values_ = nullptr;
+  size_ = 0;
+  capacity_ = 0;
+}
+
+// Ребра по паре концов для check_binding и find_edge_id: открытая
+// адресация с линейным пробированием в одном векторе слотов. Ключ -
+// пара (min, max) id концов, поэтому порядок концов не важен, а петля
+// (v, v) - обычный ключ. Поиск - O(1) в среднем: таблица заполнена
+// не больше чем наполовину, слот - 12 байт. reserve выделяет ровно
+// вдвое больше слотов, чем ребер, без округления до степени двойки,
+// так что индекс занимает 24 байта на ребро. Хешируется только меньший
+// конец, больший прибавляется к номеру слота как есть: пары одной
+// вершины с подряд идущими id лежат в подряд идущих слотах, и перебор
+// кандидатов уровня читает таблицу последовательно, а не вразброс.
+// Повторное ребро (его пропускает только ValidationMode::Off) в индекс
+// не попадает, find находит первое.
+class VertexPairIndex {
+ public:
+  struct Slot {
+    VertexId min_vertex_id = 0;
+    VertexId max_vertex_id = 0;
+    // Пустой слот - NO_EDGE
+    EdgeId edge_id = NO_EDGE;
+  };
+
+  VertexPairIndex() = default;
+  explicit VertexPairIndex(std::pmr::memory_resource* memory_resource)
+      : slots_(memory_resource) {}
+
+  void reserve(int edges_count);
+  void insert(const VertexId& first_vertex_id,
+              const VertexId& second_vertex_id,
+              const EdgeId& edge_id);
+  std::optional<EdgeId> find(const VertexId& first_vertex_id,
+                             const VertexId& second_vertex_id) const;
+  int size() const { return size_; }
+
+ private:
+  static constexpr EdgeId NO_EDGE = -1;
+
+  std::pmr::vector<Slot> slots_;
+  int size_ = 0;
+  // Смещение пар меньшего конца - старшие биты его произведения
+  // на константу
+  int get_first_slot_idx(const VertexId& min_vertex_id,
+                         const VertexId& max_vertex_id) const;
+  int get_next_slot_idx(int idx) const {
+    return idx + 1 < int(slots_.size()) ? idx + 1 : 0;
+  }
+  void rehash(int slots_count);
+};
+
+// Хранилища вершин и ребер графа по id. Id выдаются подряд с нуля,
+// поэтому по умолчанию это DenseIdMap: get_vertex и get_edge - обращение
+// к вектору без хеша. Хеш-таблица оставлена для разреженных id. Обе
+// таблицы берут память из memory_resource графа.
+struct DenseGraphStorage {
+  template <typename Key, typename Value>
+  using Map = DenseIdMap<Key, Value>;
+};
+
+struct HashGraphStorage {
+  template <typename Key, typename Value>
+  using Map = std::pmr::unordered_map<Key, Value>;
+};
+
+class FrozenGraph;
+
+// Граф с хранилищем Storage. Реализация лежит в graph.cpp и явно
+// инстанцирована для DenseGraphStorage и HashGraphStorage.
+// Вершины, ребра, списки соседей, уровни глубины и VertexPairIndex лежат
+// в memory_resource, переданном при создании: с монотонной ареной
+// (arena.hpp) граф освобождается вместе с ней, а не по одному выделению.
+// Копия графа, как у std::pmr, лежит в ресурсе по умолчанию, перемещенный
+// граф остается в ресурсе исходного.
+template <typename Storage>
+class BasicGraph {
+ public:
+  using VertexMap = typename Storage::template Map<VertexId, Vertex>;
+  using EdgeMap = typename Storage::template Map<EdgeId, Edge>;
+
+  BasicGraph() : BasicGraph(std::pmr::get_default_resource()) {}
+  explicit BasicGraph(std::pmr::memory_resource* memory_resource)
+      : vertex_map_(memory_resource),
+        edge_map_(memory_resource),
+        vertex_pair_index_(memory_resource),
+        depth_map_(1, memory_resource) {}
+
+  std::pmr::memory_resource* get_memory_resource() const {
+    return vertex_map_.get_allocator().resource();
+  }
+
+  VertexId add_vertex();
+
+  // Выделяет место под vertices_count вершин, edges_count ребер и
+  // depth + 1 уровней, чтобы при генерации не было перевыделений
+  void reserve(int vertices_count, int edges_count, const Depth& depth);
+
+  // Добавляет count детей вершины parent_vertex_id сразу с серыми ребрами,
+  // место под вершины и ребра выделяется один раз на всю группу.
+  // Дети получают подряд идущие id, возвращается id первого из них.
+  VertexId add_children(const VertexId& parent_vertex_id, int count);
+
+  // Добавляет по ребенку с серым ребром на каждый элемент
+  // parent_vertex_ids (все родители на одной глубине, дети одного
+  // родителя идут подряд), место выделяется один раз на весь уровень.
+  // В DenseGraphStorage большой уровень делится на куски по родителям,
+  // и потоки создают вершины и ребра своих кусков прямо на их местах.
+  // Возвращает id первого ребенка.
+  VertexId add_layer(VertexIdSpan parent_vertex_ids);
+
+  // При validation_mode != Off бросает std::runtime_error, если вершины
+  // нет, вершины уже связаны или цвет не подходит к глубинам вершин
+  void add_edge(const VertexId& from_vertex_id,
+                const VertexId& to_vertex_id,
+                const Edge::Color& new_edge_color = Edge::Color::Gray);
+
+  void set_validation_mode(const ValidationMode& validation_mode) {
+    validation_mode_ = validation_mode;
+  }
+  const ValidationMode& get_validation_mode() const {
+    return validation_mode_;
+  }
+
+  // O(1) по VertexPairIndex, порядок вершин не важен
+  bool check_binding(const VertexId& from_vertex_id,
+                     const VertexId& to_vertex_id) const;
+  std::optional<EdgeId> find_edge_id(const VertexId& from_vertex_id,
+                                     const VertexId& to_vertex_id) const;
+
+  bool has_vertex(const VertexId& id) const {
+    return vertex_map_.find(id) != vertex_map_.end();
+  }
+
+  bool has_edge(const EdgeId& id) const {
+    return edge_map_.find(id) != edge_map_.end();
+  }
+
+  const VertexMap& get_vertex_map() const { return vertex_map_; }
+  const EdgeMap& get_edge_map() const { return edge_map_; }
+
+  // O(1): счетчики ведутся при добавлении ребер
+  int count_edges_of_color(const Edge::Color& color) const {
+    return edges_of_color_counts_[int(color)];
+  }
+
+  Depth get_depth() const;
+
+  // Действителен, пока в граф не добавлены вершины
+  VertexIdSpan get_vertices_at_depth(const Depth& depth) const;
+
+  const Vertex& get_vertex(const VertexId& id) const;
+
+  const Edge& get_edge(const EdgeId& id) const;
+
+  // Снимок графа для чтения (frozen_graph.hpp): плоские массивы вместо
+  // таблиц вершин и ребер и списков соседей в каждой вершине
+  FrozenGraph freeze() const;
+
+ private:
+  // Id вершин одного уровня глубины
+  using DepthLevel = std::pmr::vector<VertexId>;
+
+  VertexId default_vertex_id_ = 0;
+  EdgeId default_edge_id_ = 0;
+  VertexMap vertex_map_;
+  EdgeMap edge_map_;
+  VertexPairIndex vertex_pair_index_;
+  std::pmr::vector<DepthLevel> depth_map_;
+  std::array<int, COLORS_COUNT> edges_of_color_counts_ = {};
+  ValidationMode validation_mode_ = ValidationMode::Cheap;
+
+  VertexId get_default_vertex_id() { return default_vertex_id_++; }
+
+  EdgeId get_default_edge_id() { return default_edge_id_++; }
+
+  Vertex& get_mutable_vertex(const VertexId& id) {
+    return const_cast<Vertex&>(get_vertex(id));
+  }
+
+  DepthLevel& get_mutable_vertices_at_depth(const Depth& depth) {
+    assert(depth <= get_depth() && "Depth level doesn't exist");
+    return depth_map_.at(depth);
+  }
+
+  VertexId add_child(const VertexId& parent_vertex_id,
+                     DepthLevel& depth_map_child_level);
+
+  DepthLevel& get_mutable_child_level(const VertexId& parent_vertex_id);
+
+  void set_vertex_depth(const VertexId& from_vertex_id,
+                        const VertexId& to_vertex_id);
+};
+
+using Graph = BasicGraph<DenseGraphStorage>;
+using HashGraph = BasicGraph<HashGraphStorage>;
+
+extern template class BasicGraph<DenseGraphStorage>;
+extern template class BasicGraph<HashGraphStorage>;
+}  // namespace uni_cpp_practice
@@ -1,9 +1,9 @@
-#pragma once
-
-#include "graph.hpp"
-
-namespace uni_cpp_practice {
-namespace graph_generation {
-Graph generate_graph(const Depth& depth, int new_vertices_num);
-}  // namespace graph_generation
-}  // namespace uni_cpp_practice
+#pragma once
+
+#include "graph.hpp"
+
+namespace uni_cpp_practice {
+namespace graph_generation {
+Graph generate_graph(const Depth& depth, int new_vertices_num);
+}  // namespace graph_generation
+}  // namespace uni_cpp_practice
@@ -1,94 +1,215 @@
-#include "graph_generation_controller.hpp"
-#include <cassert>
-
-namespace uni_cpp_practice {
-
-GraphGenerationController::GraphGenerationController(
-    int threads_count,
-    int graphs_count,
-    const GraphGenerator::Params& graph_generator_params)
-    : graphs_count_(graphs_count), graph_generator_(graph_generator_params) {
-  for (int i = 0; i < threads_count; ++i) {
-    workers_.emplace_back(
-        [&jobs_ = jobs_,
-         &mutex_jobs_ = mutex_jobs_]() -> std::optional<JobCallback> {
-          const std::lock_guard lock(mutex_jobs_);
-          if (jobs_.empty()) {
-            return std::nullopt;
-          }
-          const auto fist_job = jobs_.front();
-          jobs_.pop_front();
-          return fist_job;
-        });
-  }
-}
-
-void GraphGenerationController::generate(
-    const GenStartedCallback& gen_started_callback,
-    const GenFinishedCallback& gen_finished_callback) {
-  for (auto& worker : workers_) {
-    worker.start();
-  }
-  std::atomic<int> jobs_counter = 0;
-  {
-    const std::lock_guard lock(mutex_jobs_);
-    for (int i = 0; i < graphs_count_; ++i) {
-      jobs_.emplace_back([&mutex_start_callback_ = mutex_start_callback_,
-                          &mutex_finish_callback_ = mutex_finish_callback_,
-                          &graph_generator_ = graph_generator_,
-                          &gen_started_callback, &gen_finished_callback,
-                          &jobs_counter = jobs_counter, i]() {
-        {
-          const std::lock_guard lock(mutex_start_callback_);
-          gen_started_callback(i);
-        }
-        auto graph = graph_generator_.generate();
-        {
-          const std::lock_guard lock(mutex_finish_callback_);
-          gen_finished_callback(i, std::move(graph));
-        }
-        ++jobs_counter;
-      });
-    }
-  }
-  while (jobs_counter < graphs_count_) {
-  }
-  for (auto& worker : workers_) {
-    worker.stop();
-  }
-}
-
-void GraphGenerationController::Worker::start() {
-  assert(state_ != State::Working && "Worker is not working");
-  state_ = State::Working;
-  thread_ =
-      std::thread([&state_ = state_, &get_job_callback_ = get_job_callback_]() {
-        while (true) {
-          if (state_ == State::ShouldTerminate) {
-            state_ = State::Idle;
-            return;
-          }
-          const auto job_optional = get_job_callback_();
-          if (job_optional.has_value()) {
-            const auto job_callback = job_optional.value();
-            job_callback();
-          }
-        }
-      });
-}
-
-void GraphGenerationController::Worker::stop() {
-  assert(state_ == State::Working && "Worker is working");
-  state_ = State::ShouldTerminate;
-  if (thread_.joinable()) {
-    thread_.join();
-  }
-}
-
-GraphGenerationController::Worker::~Worker() {
-  if (state_ == State::Working) {
-    stop();
-  }
-}
-
-}  // namespace uni_cpp_practice
+#include "graph_generation_controller.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "logger.hpp"
+
+namespace {
+// Доля доступной памяти, после которой генерация идет с предупреждением
+constexpr double MEMORY_WARNING_FRACTION = 0.5;
+constexpr double BYTES_IN_MEGABYTE = 1024 * 1024;
+
+// Доступная память в байтах по MemAvailable из /proc/meminfo: в отличие
+// от свободной, она учитывает кэш страниц, который ядро может отдать.
+// На системах без такого счетчика - вся физическая память
+double get_available_memory_bytes() {
+  auto meminfo = std::ifstream("/proc/meminfo");
+  std::string name;
+  double kilobytes = 0;
+  while (meminfo >> name >> kilobytes) {
+    if (name == "MemAvailable:") {
+      return kilobytes * 1024;
+    }
+    meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+  return double(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE);
+}
+}  // namespace
+
+namespace uni_cpp_practice {
+
+GraphGenerationController::GraphGenerationController(
+    int threads_count,
+    int graphs_count,
+    const GraphGenerator::Params& graph_generator_params)
+    : graphs_count_(graphs_count), graph_generator_(graph_generator_params) {
+  for (int i = 0; i < threads_count; ++i) {
+    workers_.emplace_back(
+        [&jobs_ = jobs_,
+         &mutex_jobs_ = mutex_jobs_]() -> std::optional<JobCallback> {
+          const std::lock_guard lock(mutex_jobs_);
+          if (jobs_.empty()) {
+            return std::nullopt;
+          }
+          const auto fist_job = jobs_.front();
+          jobs_.pop_front();
+          return fist_job;
+        });
+  }
+}
+
+void GraphGenerationController::check_memory(double shared_bytes,
+                                             double job_bytes,
+                                             int jobs_count) const {
+  // Одновременно в памяти не меньше задания на каждый поток
+  const double jobs_in_memory = std::min<double>(workers_.size(), jobs_count);
+  const double graphs_in_memory =
+      jobs_in_memory * graphs_count_ / std::max(jobs_count, 1);
+  const double required_bytes = shared_bytes + jobs_in_memory * job_bytes;
+  const double available_bytes = get_available_memory_bytes();
+  if (available_bytes <= 0) {
+    return;
+  }
+  std::stringstream message;
+  message << std::fixed << std::setprecision(0) << graphs_in_memory
+          << " graphs may need "
+          << required_bytes / BYTES_IN_MEGABYTE << " MB, available "
+          << available_bytes / BYTES_IN_MEGABYTE << " MB";
+  if (required_bytes > available_bytes) {
+    throw std::runtime_error("Not enough memory: " + message.str());
+  }
+  if (required_bytes > MEMORY_WARNING_FRACTION * available_bytes) {
+    Logger::get_instance().log("Warning: " + message.str() + "\n");
+  }
+}
+
+void GraphGenerationController::run_jobs(
+    int jobs_count,
+    const std::function<void(int, std::pmr::memory_resource*)>& job) {
+  for (auto& worker : workers_) {
+    worker.start();
+  }
+  std::atomic<int> jobs_counter = 0;
+  {
+    const std::lock_guard lock(mutex_jobs_);
+    for (int i = 0; i < jobs_count; ++i) {
+      jobs_.emplace_back([&job, &jobs_counter = jobs_counter,
+                          i](std::pmr::memory_resource* memory_resource) {
+        job(i, memory_resource);
+        ++jobs_counter;
+      });
+    }
+  }
+  while (jobs_counter < jobs_count) {
+  }
+  for (auto& worker : workers_) {
+    worker.stop();
+  }
+}
+
+void GraphGenerationController::generate(
+    const GenStartedCallback& gen_started_callback,
+    const GenFinishedCallback& gen_finished_callback) {
+  check_memory(0, graph_generator_.estimate_size().bytes_bound,
+               graphs_count_);
+  const auto job = [this, &gen_started_callback, &gen_finished_callback](
+                       int i, std::pmr::memory_resource* memory_resource) {
+    {
+      const std::lock_guard lock(mutex_start_callback_);
+      gen_started_callback(i);
+    }
+    const auto graph = graph_generator_.generate(i, memory_resource);
+    {
+      const std::lock_guard lock(mutex_finish_callback_);
+      gen_finished_callback(i, graph);
+    }
+  };
+  run_jobs(graphs_count_, job);
+}
+
+void GraphGenerationController::generate_batches(
+    const GenStartedCallback& gen_started_callback,
+    const BatchFinishedCallback& batch_finished_callback) {
+  const int batches_count = (graphs_count_ + BATCH_LANES - 1) / BATCH_LANES;
+  check_memory(0,
+               std::min(BATCH_LANES, graphs_count_) *
+                   graph_generator_.estimate_size().bytes_bound,
+               batches_count);
+  // Пакет не создает Graph, поэтому арена рабочего ему не нужна
+  const auto job = [this, &gen_started_callback, &batch_finished_callback](
+                       int batch_idx, std::pmr::memory_resource*) {
+    const int first_graph_index = batch_idx * BATCH_LANES;
+    const int graphs_count =
+        std::min(BATCH_LANES, graphs_count_ - first_graph_index);
+    {
+      const std::lock_guard lock(mutex_start_callback_);
+      for (int i = 0; i < graphs_count; ++i) {
+        gen_started_callback(first_graph_index + i);
+      }
+    }
+    const auto batch =
+        graph_generator_.generate_batch(first_graph_index, graphs_count);
+    {
+      const std::lock_guard lock(mutex_finish_callback_);
+      batch_finished_callback(batch);
+    }
+  };
+  run_jobs(batches_count, job);
+}
+
+void GraphGenerationController::generate_variants(
+    const GenStartedCallback& gen_started_callback,
+    const VariantFinishedCallback& variant_finished_callback) {
+  const auto estimate = graph_generator_.estimate_size();
+  check_memory(estimate.skeleton_bytes_bound, estimate.overlay_bytes_bound,
+               graphs_count_);
+  const auto skeleton = graph_generator_.generate_skeleton();
+  // Варианты не создают Graph, их списки ребер живут дольше задания,
+  // поэтому арена рабочего им не нужна
+  const auto job = [this, &gen_started_callback, &variant_finished_callback,
+                    &skeleton](int i, std::pmr::memory_resource*) {
+    {
+      const std::lock_guard lock(mutex_start_callback_);
+      gen_started_callback(i);
+    }
+    auto variant = graph_generator_.generate_variant(skeleton, i);
+    {
+      const std::lock_guard lock(mutex_finish_callback_);
+      variant_finished_callback(i, std::move(variant));
+    }
+  };
+  run_jobs(graphs_count_, job);
+}
+
+void GraphGenerationController::Worker::start() {
+  assert(state_ != State::Working && "Worker is not working");
+  state_ = State::Working;
+  thread_ = std::thread([&state_ = state_,
+                         &get_job_callback_ = get_job_callback_,
+                         &arena_ = arena_]() {
+    while (true) {
+      if (state_ == State::ShouldTerminate) {
+        state_ = State::Idle;
+        return;
+      }
+      const auto job_optional = get_job_callback_();
+      if (job_optional.has_value()) {
+        const auto job_callback = job_optional.value();
+        job_callback(&arena_);
+        arena_.reset();
+      }
+    }
+  });
+}
+
+void GraphGenerationController::Worker::stop() {
+  assert(state_ == State::Working && "Worker is working");
+  state_ = State::ShouldTerminate;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+GraphGenerationController::Worker::~Worker() {
+  if (state_ == State::Working) {
+    stop();
+  }
+}
+
+}  // namespace uni_cpp_practice
@@ -1,55 +1,97 @@
-#pragma once
-
-#include <atomic>
-#include <functional>
-#include <list>
-#include <mutex>
-#include <thread>
-#include "graph_generator.hpp"
-
-namespace uni_cpp_practice {
-
-class GraphGenerationController {
- public:
-  using JobCallback = std::function<void()>;
-  using GetJobCallback = std::function<std::optional<JobCallback>()>;
-  using GenStartedCallback = std::function<void(int)>;
-  using GenFinishedCallback = std::function<void(int, Graph)>;
-
-  class Worker {
-   public:
-    explicit Worker(const GetJobCallback& get_job_callback)
-        : get_job_callback_(get_job_callback){};
-
-    enum class State { Idle, Working, ShouldTerminate };
-
-    void start();
-    void stop();
-
-    ~Worker();
-
-   private:
-    std::thread thread_;
-    GetJobCallback get_job_callback_;
-    std::atomic<State> state_ = State::Idle;
-  };
-
-  GraphGenerationController(
-      int threads_count,
-      int graphs_count,
-      const GraphGenerator::Params& graph_generator_params);
-
-  void generate(const GenStartedCallback& gen_started_callback,
-                const GenFinishedCallback& gen_finished_callback);
-
- private:
-  std::list<Worker> workers_;
-  std::list<JobCallback> jobs_;
-  const int graphs_count_;
-  const GraphGenerator graph_generator_;
-  std::mutex mutex_jobs_;
-  std::mutex mutex_start_callback_;
-  std::mutex mutex_finish_callback_;
-};
-
-}  // namespace uni_cpp_practice
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "arena.hpp"
+#include "graph_generator.hpp"
+
+namespace uni_cpp_practice {
+
+class GraphGenerationController {
+ public:
+  // Задание получает арену своего рабочего, она сбрасывается после
+  // задания: все, что в ней выделено, должно умереть до его конца
+  using JobCallback = std::function<void(std::pmr::memory_resource*)>;
+  using GetJobCallback = std::function<std::optional<JobCallback>()>;
+  using GenStartedCallback = std::function<void(int)>;
+  // Граф лежит в арене рабочего и действителен, пока идет вызов.
+  // Чтобы сохранить граф, его нужно скопировать: копия создается
+  // в ресурсе по умолчанию.
+  using GenFinishedCallback = std::function<void(int, const Graph&)>;
+  using BatchFinishedCallback = std::function<void(const GraphBatch&)>;
+  using VariantFinishedCallback = std::function<void(int, GraphVariant)>;
+
+  class Worker {
+   public:
+    explicit Worker(const GetJobCallback& get_job_callback)
+        : get_job_callback_(get_job_callback){};
+
+    enum class State { Idle, Working, ShouldTerminate };
+
+    void start();
+    void stop();
+
+    ~Worker();
+
+   private:
+    std::thread thread_;
+    GetJobCallback get_job_callback_;
+    std::atomic<State> state_ = State::Idle;
+    // Переиспользуется всеми заданиями рабочего: после первых графов
+    // генерация не выделяет память под них из кучи
+    Arena arena_;
+  };
+
+  GraphGenerationController(
+      int threads_count,
+      int graphs_count,
+      const GraphGenerator::Params& graph_generator_params);
+
+  // Перед запуском сверяет оценку памяти графов, которые будут
+  // генерироваться одновременно, со свободной памятью: если ее не хватит,
+  // бросает std::runtime_error, если впритык - пишет предупреждение в лог
+  void generate(const GenStartedCallback& gen_started_callback,
+                const GenFinishedCallback& gen_finished_callback);
+
+  // Те же графы, что и generate, но одно задание строит BATCH_LANES
+  // графов подряд через GraphGenerator::generate_batch: для маленьких
+  // графов это убирает накладные расходы на задание и Graph на каждый
+  // граф. gen_started_callback вызывается для каждого графа пакета,
+  // batch_finished_callback - для пакета целиком. Только режим Layers.
+  void generate_batches(const GenStartedCallback& gen_started_callback,
+                        const BatchFinishedCallback& batch_finished_callback);
+
+  // Режим "одно дерево, разные цветные ребра": серое дерево строится
+  // один раз в вызывающем потоке, а каждое задание добавляет к нему только
+  // свои цветные ребра. i-й вариант - это generate(i) с серым деревом
+  // generate(0). Память проверяется так же, как в generate.
+  void generate_variants(
+      const GenStartedCallback& gen_started_callback,
+      const VariantFinishedCallback& variant_finished_callback);
+
+ private:
+  std::list<Worker> workers_;
+  std::list<JobCallback> jobs_;
+  const int graphs_count_;
+  const GraphGenerator graph_generator_;
+  std::mutex mutex_jobs_;
+  std::mutex mutex_start_callback_;
+  std::mutex mutex_finish_callback_;
+
+  // shared_bytes - память, общая для всех заданий, job_bytes - память
+  // одного из jobs_count заданий
+  void check_memory(double shared_bytes, double job_bytes, int jobs_count)
+      const;
+  // Раздает jobs_count заданий job(i, арена рабочего) рабочим и ждет
+  // их завершения
+  void run_jobs(
+      int jobs_count,
+      const std::function<void(int, std::pmr::memory_resource*)>& job);
+};
+
+}  // namespace uni_cpp_practice
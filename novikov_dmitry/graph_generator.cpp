@@ -1,258 +1,2195 @@
-#include "graph_generator.hpp"
-#include <array>
-#include <atomic>
-#include <cassert>
-#include <functional>
-#include <limits>
-#include <list>
-#include <random>
-#include <thread>
-
-namespace {
-
-constexpr int MAX_THREADS_COUNT = 4;
-
-using uni_cpp_practice::Depth;
-using uni_cpp_practice::Edge;
-using uni_cpp_practice::Graph;
-using uni_cpp_practice::Vertex;
-using uni_cpp_practice::VertexId;
-using Params = uni_cpp_practice::GraphGenerator::Params;
-
-float get_color_probability(const Edge::Color& color) {
-  switch (color) {
-    case Edge::Color::Green:
-      return 0.1;
-    case Edge::Color::Blue:
-      return 0.25;
-    case Edge::Color::Red:
-      return 0.33;
-    case Edge::Color::Yellow:
-      return 1.0;
-    case Edge::Color::Gray:
-      return 1.0;
-  }
-}
-
-bool is_lucky(float probability) {
-  assert(probability + std::numeric_limits<float>::epsilon() >= 0 &&
-         probability - std::numeric_limits<float>::epsilon() <= 1.0 &&
-         "given probability is incorrect");
-  static std::knuth_b rand_engine{};
-  std::mt19937 rng{rand_engine()};
-  std::bernoulli_distribution bernoullu_distribution_var(probability);
-  return bernoullu_distribution_var(rng);
-}
-
-int get_random_number(int size) {
-  std::random_device
-      rd;  // Will be used to obtain a seed for the random number engine
-  std::default_random_engine gen(rd());
-  std::uniform_int_distribution<int> distrib(0, size - 1);
-  return distrib(gen);
-}
-
-void generate_green_edges(Graph& graph, std::mutex& mutex_add_edge) {
-  const float probability = get_color_probability(Edge::Color::Green);
-  for (const auto& [current_vertex_id, current_vertex] :
-       graph.get_vertex_map()) {
-    if (is_lucky(probability)) {
-      const std::lock_guard lock(mutex_add_edge);
-      graph.add_edge(current_vertex_id, current_vertex_id, Edge::Color::Green);
-    }
-  }
-}
-
-void generate_blue_edges(Graph& graph, std::mutex& mutex_add_edge) {
-  const float probability = get_color_probability(Edge::Color::Blue);
-  // так как на нулевом уровне только одна вершина == нулевая, нет смысла ее
-  // учитывать
-  for (Depth current_depth = 1; current_depth <= graph.get_depth();
-       ++current_depth) {
-    const auto& vertices_at_depth = graph.get_vertices_at_depth(current_depth);
-    for (int idx = 0; idx < vertices_at_depth.size() - 1; ++idx) {
-      if (is_lucky(probability)) {
-        const std::lock_guard lock(mutex_add_edge);
-        graph.add_edge(vertices_at_depth[idx], vertices_at_depth[idx + 1],
-                       Edge::Color::Blue);
-      }
-    }
-  }
-}
-
-void generate_yellow_edges(Graph& graph, std::mutex& mutex_add_edge) {
-  float probability =
-      get_color_probability(Edge::Color::Yellow) / (graph.get_depth() - 1);
-  float yellow_edge_probability = probability;
-  //так как вероятность генерации желтых ребер из нулевой вершины должна быть
-  //нулевой, то можно просто не рассматривать эту вершину
-  for (Depth current_depth = 1; current_depth < graph.get_depth();
-       ++current_depth) {
-    const auto& vertices_at_depth = graph.get_vertices_at_depth(current_depth);
-    const auto& vertices_at_next_depth =
-        graph.get_vertices_at_depth(current_depth + 1);
-    for (const auto& current_vertex_id : vertices_at_depth) {
-      if (is_lucky(yellow_edge_probability)) {
-        std::vector<VertexId> not_binded_vertices;
-        for (const auto& next_vertex_id : vertices_at_next_depth) {
-          const auto is_binded = [&graph, &mutex_add_edge, &current_vertex_id,
-                                  &next_vertex_id]() {
-            const std::lock_guard lock(mutex_add_edge);
-            return graph.check_binding(current_vertex_id, next_vertex_id);
-          }();
-          if (!is_binded) {
-            not_binded_vertices.push_back(next_vertex_id);
-          }
-        }
-        if (not_binded_vertices.size()) {
-          const int idx = get_random_number(not_binded_vertices.size());
-          const std::lock_guard lock(mutex_add_edge);
-          graph.add_edge(current_vertex_id, not_binded_vertices[idx],
-                         Edge::Color::Yellow);
-        }
-      }
-    }
-    yellow_edge_probability += probability;
-  }
-}
-
-void generate_red_edges(Graph& graph, std::mutex& mutex_add_edge) {
-  const float probability = get_color_probability(Edge::Color::Red);
-  for (Depth current_depth = 0; current_depth < graph.get_depth() - 1;
-       ++current_depth) {
-    const auto& vertices_at_depth = graph.get_vertices_at_depth(current_depth);
-    const auto& vertices_at_next_depth =
-        graph.get_vertices_at_depth(current_depth + 2);
-    for (const auto& current_vertex_id : vertices_at_depth) {
-      if (is_lucky(probability)) {
-        const int index = get_random_number(vertices_at_next_depth.size());
-        const std::lock_guard lock(mutex_add_edge);
-        graph.add_edge(current_vertex_id, vertices_at_next_depth[index],
-                       Edge::Color::Red);
-      }
-    }
-  }
-}
-}  // namespace
-
-namespace uni_cpp_practice {
-
-void GraphGenerator::generate_gray_branch(Graph& graph,
-                                          std::mutex& mutex_add,
-                                          const VertexId& parent_vertex_id,
-                                          const Depth current_depth) const {
-  assert(current_depth <= params_.depth && "Depth error");
-  const auto new_vertex_id = [&graph, &mutex_add, &parent_vertex_id]() {
-    const std::lock_guard lock(mutex_add);
-    const auto& new_vertex_id = graph.add_vertex();
-    graph.add_edge(parent_vertex_id, new_vertex_id);
-    return new_vertex_id;
-  }();
-  if (current_depth == params_.depth) {
-    return;
-  }
-  const float probability = get_color_probability(Edge::Color::Gray);
-  const float new_vertex_probability =
-      probability * (1 - (float(current_depth) / float(params_.depth)));
-  for (int i = 0; i < params_.new_vertices_num; ++i) {
-    if (is_lucky(new_vertex_probability)) {
-      generate_gray_branch(graph, mutex_add, new_vertex_id, current_depth + 1);
-    }
-  }
-}
-
-void GraphGenerator::generate_gray_edges(
-    Graph& graph,
-    const VertexId& parent_vertex_id) const {
-  // Job - это lambda функция,
-  // которая энкапсулирует в себе генерацию однйо ветви
-  using JobCallback = std::function<void()>;
-  auto jobs = std::list<JobCallback>();
-
-  // Заполняем список работ для воркеров
-  std::atomic<int> jobs_counter = 0;
-  std::mutex mutex_add;
-  Depth current_depth = 0;
-  for (int i = 0; i < params_.new_vertices_num; i++) {
-    jobs.emplace_back([this, &graph, &mutex_add, &jobs_counter,
-                       &parent_vertex_id, current_depth]() {
-      generate_gray_branch(graph, mutex_add, parent_vertex_id,
-                           current_depth + 1);
-      ++jobs_counter;
-    });
-  }
-
-  // Создаем воркера,
-  // который в бесконечном цикле проверяет,
-  // есть ли работа, и выполняет её
-  std::mutex mutex_jobs;
-  std::atomic<bool> should_terminate = false;
-  const auto worker = [&should_terminate, &mutex_jobs, &jobs]() {
-    while (true) {
-      // Проверка флага, должны ли мы остановить поток
-      if (should_terminate) {
-        return;
-      }
-      // Проверяем, есть ли для нас работа
-      const auto job_optional = [&mutex_jobs,
-                                 &jobs]() -> std::optional<JobCallback> {
-        const std::lock_guard lock(mutex_jobs);
-        if (jobs.empty()) {
-          return std::nullopt;
-        }
-        const auto first_job = jobs.front();
-        jobs.pop_front();
-        return first_job;
-      }();
-      if (job_optional.has_value()) {
-        // Работа есть, выполняем её
-        const auto& job = job_optional.value();
-        job();
-      }
-    }
-  };
-
-  // Создаем и запускаем потоки с воркерами
-  // MAX_THREADS_COUNT = 4
-  std::array<std::thread, MAX_THREADS_COUNT> threads;
-  for (int i = 0; i < MAX_THREADS_COUNT; ++i) {
-    threads[i] = std::thread(worker);
-  }
-
-  // Ждем, когда все ветви будут сгенерированы
-  while (jobs_counter < params_.new_vertices_num) {
-  }
-
-  // Останавливем всех воркеров и потоки
-  should_terminate = true;
-  for (auto& thread : threads) {
-    thread.join();
-  }
-}
-
-Graph GraphGenerator::generate() const {
-  auto graph = Graph();
-  const VertexId& new_vertex_id = graph.add_vertex();
-  std::mutex mutex_add_edge;
-  if (params_.depth == 0 || params_.new_vertices_num == 0) {
-    std::thread green_thread(generate_green_edges, std::ref(graph),
-                             std::ref(mutex_add_edge));
-    green_thread.join();
-    return graph;
-  }
-  generate_gray_edges(graph, new_vertex_id);
-  std::thread green_thread(generate_green_edges, std::ref(graph),
-                           std::ref(mutex_add_edge));
-  std::thread yellow_thread(generate_yellow_edges, std::ref(graph),
-                            std::ref(mutex_add_edge));
-  std::thread red_thread(generate_red_edges, std::ref(graph),
-                         std::ref(mutex_add_edge));
-  std::thread blue_thread(generate_blue_edges, std::ref(graph),
-                          std::ref(mutex_add_edge));
-  green_thread.join();
-  yellow_thread.join();
-  red_thread.join();
-  blue_thread.join();
-  return graph;
-}
-}  // namespace uni_cpp_practice
+#include "graph_generator.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include "graph_printer.hpp"
+#include "graph_validation.hpp"
+
+namespace {
+
+constexpr int MAX_THREADS_COUNT = 4;
+// Уровни меньше этого размера дешевле обработать в одном потоке
+constexpr int MIN_PARALLEL_LAYER_SIZE = 4096;
+constexpr int NO_PARENT = -1;
+// scope потоков, привязанных к уровню глубины, а не к вершине
+constexpr int LAYER_SCOPE = -1;
+// scope единственного потока дерева режима PreferentialAttachment
+constexpr int ATTACHMENT_SCOPE = -2;
+// Во сколько стандартных отклонений от среднего берется оценка сверху
+constexpr double ESTIMATE_BOUND_DEVIATIONS = 3;
+// Накладные расходы аллокатора на одно выделение
+constexpr double ALLOCATION_OVERHEAD_BYTES = 16;
+// Во сколько раз можно увеличить вероятности плана на каждом уровне,
+// чтобы было чем добирать вершины по ходу генерации
+constexpr double TARGET_HEADROOM = 2;
+// Уровни разыгрываются с запасом относительно оставшегося бюджета,
+// чтобы лишнее отрезалось, а не не хватало вершин
+constexpr double TARGET_OVERSHOOT = 1.01;
+constexpr int PROBABILITY_SCALE_SEARCH_STEPS = 50;
+// Во сколько раз у графа с целью по ребрам может быть больше вершин, чем
+// в плане: число ребер на вершину зависит от формы дерева
+constexpr double TARGET_VERTICES_HEADROOM = 1.1;
+// Размер пробного дерева, по которому оценивается число ребер на вершину
+// в режиме PreferentialAttachment
+constexpr int ATTACHMENT_PILOT_VERTICES_COUNT = 1 << 14;
+constexpr uni_cpp_practice::RandomSource::Seed ATTACHMENT_PILOT_SEED = 0;
+// Во сколько раз дерево режима PreferentialAttachment с целью по ребрам
+// может быть больше оценки по пробному дереву: у деревьев с разными seed
+// число ребер на вершину отличается на несколько процентов
+constexpr double ATTACHMENT_VERTICES_HEADROOM = 1.15;
+// Число шагов грубого поиска размера такого дерева
+constexpr int ATTACHMENT_SEARCH_STEPS = 4096;
+
+using uni_cpp_practice::BATCH_LANES;
+using uni_cpp_practice::COLORS_COUNT;
+using uni_cpp_practice::Depth;
+using uni_cpp_practice::Edge;
+using uni_cpp_practice::EdgeId;
+using uni_cpp_practice::Graph;
+using uni_cpp_practice::GraphPrinter;
+using uni_cpp_practice::LuckyMask;
+using uni_cpp_practice::RandomSource;
+using uni_cpp_practice::Vertex;
+using uni_cpp_practice::VertexId;
+using uni_cpp_practice::VertexIdSpan;
+using uni_cpp_practice::VertexPairIndex;
+using Seed = RandomSource::Seed;
+using ColorKernel = uni_cpp_practice::GraphGeneratorBase::ColorKernel;
+// Ребра одного прохода, которые будут добавлены в граф после его завершения
+using EdgeList = std::pmr::vector<std::pair<VertexId, VertexId>>;
+
+// Оценка сверху цены вершины и ребра в Graph: элемент DenseIdMap
+// (вместе со встроенными соседями), id в depth_map_, выделение под список
+// соседей, если он не поместился в Vertex, запись соседа у обоих концов
+// ребра (с запасом вместимости вдвое) и два слота VertexPairIndex
+// (таблица заполнена не больше чем наполовину)
+constexpr double VERTEX_BYTES =
+    sizeof(Vertex) + ALLOCATION_OVERHEAD_BYTES + sizeof(VertexId);
+constexpr double EDGE_BYTES = sizeof(Edge) + 2 * 2 * sizeof(Vertex::Neighbor) +
+                              2 * sizeof(VertexPairIndex::Slot);
+
+Seed get_random_seed() {
+  std::random_device rd;
+  return (Seed(rd()) << 32) | rd();
+}
+
+// yellow_probability - вероятность желтого цвета в политике, у вершин
+// на глубине depth она уменьшается пропорционально глубине
+float get_yellow_edge_probability(float yellow_probability,
+                                  const Depth& depth,
+                                  const Depth& graph_depth) {
+  return yellow_probability * depth / (graph_depth - 1);
+}
+
+// Среднее число потомков вершины глубины depth в дереве, где у вершины
+// глубины d Binomial(trials, probability * (1 - d / max_depth)) детей
+double get_descendants_mean(int trials,
+                            double probability,
+                            const Depth& depth,
+                            const Depth& max_depth) {
+  double descendants_mean = 0;
+  double layer_mean = 1;
+  for (Depth current_depth = depth; current_depth < max_depth;
+       ++current_depth) {
+    layer_mean *= trials * probability *
+                  (1 - double(current_depth) / double(max_depth));
+    descendants_mean += layer_mean;
+  }
+  return descendants_mean;
+}
+
+// Множитель вероятностей из [0, 1], при котором у parents_count вершин
+// глубины depth в среднем descendants_count потомков, или 1, если их
+// не хватает и без множителя
+double find_probability_scale(int trials,
+                              double probability,
+                              const Depth& depth,
+                              const Depth& max_depth,
+                              double parents_count,
+                              double descendants_count) {
+  const auto get_mean = [=](double scale) {
+    return parents_count *
+           get_descendants_mean(trials, scale * probability, depth, max_depth);
+  };
+  if (get_mean(1) <= descendants_count) {
+    return 1;
+  }
+  double low_scale = 0;
+  double high_scale = 1;
+  for (int step = 0; step < PROBABILITY_SCALE_SEARCH_STEPS; ++step) {
+    const double scale = (low_scale + high_scale) / 2;
+    (get_mean(scale) < descendants_count ? low_scale : high_scale) = scale;
+  }
+  return high_scale;
+}
+
+// Среднее число ребер графа, у которого средние размеры уровней -
+// layer_means, а всего в среднем vertices_count вершин
+template <typename Policy>
+double get_edges_mean(const Policy& policy,
+                      const std::vector<double>& layer_means,
+                      double vertices_count) {
+  // Ожидаемая глубина графа: сумма вероятностей дойти до каждого уровня,
+  // вероятность оценивается сверху средним размером уровня
+  double expected_depth = 0;
+  for (Depth current_depth = 1; current_depth < Depth(layer_means.size());
+       ++current_depth) {
+    expected_depth += std::min(1.0, layer_means[current_depth]);
+  }
+  const Depth graph_depth = std::lround(expected_depth);
+  double edges_count =
+      (vertices_count - 1) +
+      policy.get_color_probability(Edge::Color::Green) * vertices_count;
+  for (Depth current_depth = 0; current_depth <= graph_depth;
+       ++current_depth) {
+    const double layer_mean = layer_means[current_depth];
+    if (current_depth > 0) {
+      edges_count += policy.get_color_probability(Edge::Color::Blue) *
+                     (layer_mean - std::min(1.0, layer_mean));
+    }
+    if (current_depth > 0 && current_depth < graph_depth) {
+      edges_count += get_yellow_edge_probability(
+                         policy.get_color_probability(Edge::Color::Yellow),
+                         current_depth, graph_depth) *
+                     layer_mean;
+    }
+    if (current_depth < graph_depth - 1) {
+      edges_count +=
+          policy.get_color_probability(Edge::Color::Red) * layer_mean;
+    }
+  }
+  return edges_count;
+}
+
+// Родители вершин дерева режима PreferentialAttachment в порядке
+// присоединения, у корня - NO_PARENT
+std::vector<VertexId> get_attachment_parent_ids(const RandomSource::Seed& seed,
+                                                int graph_index,
+                                                int vertices_count) {
+  assert(vertices_count <= uni_cpp_practice::MAX_ATTACHMENT_VERTICES_COUNT);
+  // Каждое ребро дерева кладет в endpoints оба своих конца, поэтому
+  // вершина встречается в нем столько раз, сколько у нее ребер, и
+  // равномерно выбранный элемент - это выбор пропорционально степени
+  // за O(1). У корня вначале ребер нет, он входит в endpoints один раз.
+  std::vector<VertexId> parent_ids(vertices_count, NO_PARENT);
+  std::vector<VertexId> endpoints;
+  endpoints.reserve(2 * std::int64_t(vertices_count) - 1);
+  endpoints.push_back(0);
+  auto random_source = RandomSource(
+      seed, {graph_index, 0, Edge::Color::Gray, ATTACHMENT_SCOPE});
+  for (VertexId vertex_id = 1; vertex_id < vertices_count; ++vertex_id) {
+    const VertexId parent_id =
+        endpoints[random_source.get_random_number(endpoints.size())];
+    parent_ids[vertex_id] = parent_id;
+    endpoints.push_back(parent_id);
+    endpoints.push_back(vertex_id);
+  }
+  return parent_ids;
+}
+
+// Средние размеры уровней пробного дерева режима PreferentialAttachment.
+// Доля цветных ребер зависит от размеров уровней, а их у такого дерева
+// аналитически не посчитать. Глубина растет как логарифм числа вершин,
+// поэтому ребер на вершину почти столько же, сколько у небольшого дерева
+// из того же процесса. Дерево не зависит ни от Params, ни от политики и
+// строится один раз на процесс, политика учитывается уже в get_edges_mean.
+const std::vector<double>& get_attachment_pilot_layer_means() {
+  static const auto layer_means = [] {
+    const auto parent_ids =
+        get_attachment_parent_ids(ATTACHMENT_PILOT_SEED, 0,
+                                  ATTACHMENT_PILOT_VERTICES_COUNT);
+    std::vector<Depth> depths(parent_ids.size(), 0);
+    std::vector<double> pilot_layer_means = {1};
+    for (VertexId vertex_id = 1; vertex_id < int(parent_ids.size());
+         ++vertex_id) {
+      // Родитель присоединен раньше ребенка
+      depths[vertex_id] = depths[parent_ids[vertex_id]] + 1;
+      if (depths[vertex_id] == Depth(pilot_layer_means.size())) {
+        pilot_layer_means.push_back(0);
+      }
+      ++pilot_layer_means[depths[vertex_id]];
+    }
+    return pilot_layer_means;
+  }();
+  return layer_means;
+}
+
+// Оставляет первым вершинам не больше budget детей в сумме,
+// возвращает их число
+int truncate_children_counts(std::vector<int>& children_counts, int budget) {
+  int children_total = 0;
+  for (auto& children_count : children_counts) {
+    children_count = std::min(children_count, budget - children_total);
+    children_total += children_count;
+  }
+  return children_total;
+}
+
+RandomSource get_layer_random_source(const Seed& seed,
+                                     int graph_index,
+                                     const Depth& depth,
+                                     const Edge::Color& pass) {
+  return RandomSource(seed, {graph_index, depth, pass, LAYER_SCOPE});
+}
+
+int get_chunk_begin(int size, int chunk_index) {
+  return std::int64_t(size) * chunk_index / MAX_THREADS_COUNT;
+}
+
+// Вызывает callback для индексов успешных испытаний из trials_count
+// испытаний с вероятностью probability. Неудачные испытания не разыгрываются
+// по одному: между успехами сразу берется геометрический пропуск, поэтому
+// число выборок пропорционально числу успехов.
+template <typename Callback>
+void for_each_lucky_index(RandomSource& random_source,
+                          float probability,
+                          int trials_count,
+                          const Callback& callback) {
+  for (int idx = random_source.get_geometric_skip(probability);
+       idx < trials_count;
+       idx += 1 + random_source.get_geometric_skip(probability)) {
+    callback(idx);
+  }
+}
+
+// Вызывает callback для индексов установленных битов маски
+template <typename Callback>
+void for_each_lucky_index(const LuckyMask& lucky_mask,
+                          const Callback& callback) {
+  for (int word_idx = 0; word_idx < int(lucky_mask.size()); ++word_idx) {
+    for (auto word = lucky_mask[word_idx]; word != 0; word &= word - 1) {
+      callback(word_idx * 64 + __builtin_ctzll(word));
+    }
+  }
+}
+
+// Делит [0, size) на MAX_THREADS_COUNT непрерывных кусков и вызывает
+// callback(chunk_index, first_idx, last_idx) для каждого в своем потоке.
+// Границы кусков зависят только от size.
+template <typename Callback>
+void for_each_chunk(int size, const Callback& callback) {
+  if (size < MIN_PARALLEL_LAYER_SIZE) {
+    for (int i = 0; i < MAX_THREADS_COUNT; ++i) {
+      callback(i, get_chunk_begin(size, i), get_chunk_begin(size, i + 1));
+    }
+    return;
+  }
+  std::array<std::thread, MAX_THREADS_COUNT> threads;
+  for (int i = 0; i < MAX_THREADS_COUNT; ++i) {
+    threads[i] = std::thread(callback, i, get_chunk_begin(size, i),
+                             get_chunk_begin(size, i + 1));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Еще не обработанные дети вершины ветви серого дерева:
+// локальные номера [next_local_id, end_local_id) на глубине depth
+struct PendingChildren {
+  int next_local_id = 0;
+  int end_local_id = 0;
+  Depth depth = 0;
+};
+
+// Ребра всех цветов, исходящие из вершин одного уровня. Учитывает
+// аллокатор: в std::pmr::vector буферы берут память из ресурса вектора,
+// из него же - временные буферы проходов уровня.
+struct LayerEdges {
+  using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+  explicit LayerEdges(const allocator_type& allocator = {})
+      : green(allocator), yellow(allocator), red(allocator), blue(allocator) {}
+  LayerEdges(LayerEdges&& other, const allocator_type& allocator)
+      : green(std::move(other.green), allocator),
+        yellow(std::move(other.yellow), allocator),
+        red(std::move(other.red), allocator),
+        blue(std::move(other.blue), allocator) {}
+
+  std::pmr::memory_resource* get_memory_resource() const {
+    return green.get_allocator().resource();
+  }
+
+  EdgeList green, yellow, red, blue;
+};
+
+// Передает выделения в upstream под мьютексом: так несколько потоков
+// берут буферы из ресурса графа, даже если это непотокобезопасная арена
+class SynchronizedResource : public std::pmr::memory_resource {
+ public:
+  explicit SynchronizedResource(std::pmr::memory_resource* upstream)
+      : upstream_(upstream) {}
+
+ private:
+  std::pmr::memory_resource* const upstream_;
+  std::mutex mutex_;
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return upstream_->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* ptr,
+                     std::size_t bytes,
+                     std::size_t alignment) override {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    upstream_->deallocate(ptr, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+// Все, что нужно проходам для ребер из уровня current_depth: сам уровень,
+// два следующих (пустые, если их нет) и глубина всего графа
+struct ColorPassLayers {
+  const Depth graph_depth;
+  const Depth current_depth;
+  const VertexIdSpan vertices_at_depth;
+  const VertexIdSpan vertices_at_next_depth;
+  const VertexIdSpan vertices_at_second_next_depth;
+};
+
+void generate_green_edges(const ColorPassLayers& layers,
+                          float probability,
+                          const Seed& seed,
+                          int graph_index,
+                          EdgeList& edges) {
+  const auto& vertices_at_depth = layers.vertices_at_depth;
+  auto random_source = get_layer_random_source(
+      seed, graph_index, layers.current_depth, Edge::Color::Green);
+  for_each_lucky_index(
+      random_source, probability, vertices_at_depth.size(),
+      [&edges, &vertices_at_depth](int idx) {
+        edges.emplace_back(vertices_at_depth[idx], vertices_at_depth[idx]);
+      });
+}
+
+void generate_blue_edges(const ColorPassLayers& layers,
+                         float probability,
+                         const Seed& seed,
+                         int graph_index,
+                         EdgeList& edges) {
+  // так как на нулевом уровне только одна вершина == нулевая, нет смысла ее
+  // учитывать
+  if (layers.current_depth == 0) {
+    return;
+  }
+  const auto& vertices_at_depth = layers.vertices_at_depth;
+  auto random_source = get_layer_random_source(
+      seed, graph_index, layers.current_depth, Edge::Color::Blue);
+  // испытание на каждую пару соседних вершин уровня
+  for_each_lucky_index(
+      random_source, probability, vertices_at_depth.size() - 1,
+      [&edges, &vertices_at_depth](int idx) {
+        edges.emplace_back(vertices_at_depth[idx], vertices_at_depth[idx + 1]);
+      });
+}
+
+// check_binding(from, to) - связаны ли вершины соседних уровней.
+// Во время прохода между ними есть только серые ребра.
+template <typename CheckBinding>
+void generate_yellow_edges(const ColorPassLayers& layers,
+                           float probability,
+                           const CheckBinding& check_binding,
+                           const Seed& seed,
+                           int graph_index,
+                           EdgeList& edges) {
+  const auto allocator = edges.get_allocator();
+  //так как вероятность генерации желтых ребер из нулевой вершины должна быть
+  //нулевой, то можно просто не рассматривать эту вершину
+  if (layers.current_depth == 0 || layers.current_depth >= layers.graph_depth) {
+    return;
+  }
+  const float yellow_edge_probability = get_yellow_edge_probability(
+      probability, layers.current_depth, layers.graph_depth);
+  const auto& vertices_at_depth = layers.vertices_at_depth;
+  const auto& vertices_at_next_depth = layers.vertices_at_next_depth;
+  // Решения для всего уровня разыгрываются одним вызовом
+  LuckyMask lucky_mask(allocator);
+  uni_cpp_practice::fill_lucky_mask(seed, graph_index, Edge::Color::Yellow,
+                                    vertices_at_depth, yellow_edge_probability,
+                                    lucky_mask);
+  for_each_lucky_index(lucky_mask, [&](int vertex_idx) {
+    const auto& current_vertex_id = vertices_at_depth[vertex_idx];
+    auto random_source = RandomSource(
+        seed, {graph_index, current_vertex_id, Edge::Color::Yellow});
+    // первое число потока уже разыграно в маске
+    random_source.get_next_uint();
+    // желтое ребро из вершины строится одно
+    std::pmr::vector<VertexId> not_binded_vertices(allocator);
+    for (const auto& next_vertex_id : vertices_at_next_depth) {
+      if (!check_binding(current_vertex_id, next_vertex_id)) {
+        not_binded_vertices.push_back(next_vertex_id);
+      }
+    }
+    if (not_binded_vertices.size()) {
+      const int idx =
+          random_source.get_random_number(not_binded_vertices.size());
+      edges.emplace_back(current_vertex_id, not_binded_vertices[idx]);
+    }
+  });
+}
+
+void generate_red_edges(const ColorPassLayers& layers,
+                        float probability,
+                        const Seed& seed,
+                        int graph_index,
+                        EdgeList& edges) {
+  if (layers.current_depth >= layers.graph_depth - 1) {
+    return;
+  }
+  const auto& vertices_at_depth = layers.vertices_at_depth;
+  const auto& vertices_at_next_depth = layers.vertices_at_second_next_depth;
+  auto random_source = get_layer_random_source(
+      seed, graph_index, layers.current_depth, Edge::Color::Red);
+  for_each_lucky_index(
+      random_source, probability, vertices_at_depth.size(),
+      [&edges, &vertices_at_depth, &vertices_at_next_depth,
+       &random_source](int idx) {
+        const int index =
+            random_source.get_random_number(vertices_at_next_depth.size());
+        edges.emplace_back(vertices_at_depth[idx],
+                           vertices_at_next_depth[index]);
+      });
+}
+
+// Счетчики ниже разыгрывают те же числа, что и generate_*_edges, но только
+// считают ребра, поэтому им нужны размеры уровней, а не сами вершины
+int count_green_edges(float probability,
+                      const Seed& seed,
+                      int graph_index,
+                      const Depth& current_depth,
+                      int layer_size) {
+  int edges_count = 0;
+  auto random_source = get_layer_random_source(
+      seed, graph_index, current_depth, Edge::Color::Green);
+  for_each_lucky_index(random_source, probability, layer_size,
+                       [&edges_count](int) { ++edges_count; });
+  return edges_count;
+}
+
+int count_blue_edges(float probability,
+                     const Seed& seed,
+                     int graph_index,
+                     const Depth& current_depth,
+                     int layer_size) {
+  if (current_depth == 0) {
+    return 0;
+  }
+  int edges_count = 0;
+  auto random_source = get_layer_random_source(
+      seed, graph_index, current_depth, Edge::Color::Blue);
+  for_each_lucky_index(random_source, probability, layer_size - 1,
+                       [&edges_count](int) { ++edges_count; });
+  return edges_count;
+}
+
+int count_red_edges(float probability,
+                    const Seed& seed,
+                    int graph_index,
+                    const Depth& current_depth,
+                    const Depth& graph_depth,
+                    int layer_size,
+                    int second_next_layer_size) {
+  if (current_depth >= graph_depth - 1) {
+    return 0;
+  }
+  int edges_count = 0;
+  auto random_source = get_layer_random_source(
+      seed, graph_index, current_depth, Edge::Color::Red);
+  // выбор вершины тоже тратит число потока, без него пропуски сдвинутся
+  for_each_lucky_index(
+      random_source, probability, layer_size,
+      [&edges_count, &random_source, second_next_layer_size](int) {
+        random_source.get_random_number(second_next_layer_size);
+        ++edges_count;
+      });
+  return edges_count;
+}
+
+// Желтое ребро из вершины есть, если она выиграла в маске и на следующем
+// уровне есть вершина, не являющаяся ее ребенком
+int count_yellow_edges(float probability,
+                       const Seed& seed,
+                       int graph_index,
+                       const Depth& current_depth,
+                       const Depth& graph_depth,
+                       VertexIdSpan vertices_at_depth,
+                       const std::vector<int>& children_counts,
+                       int next_layer_size) {
+  if (current_depth == 0 || current_depth >= graph_depth) {
+    return 0;
+  }
+  LuckyMask lucky_mask;
+  uni_cpp_practice::fill_lucky_mask(
+      seed, graph_index, Edge::Color::Yellow, vertices_at_depth,
+      get_yellow_edge_probability(probability, current_depth, graph_depth),
+      lucky_mask);
+  int edges_count = 0;
+  for_each_lucky_index(lucky_mask, [&](int vertex_idx) {
+    if (children_counts[vertex_idx] < next_layer_size) {
+      ++edges_count;
+    }
+  });
+  return edges_count;
+}
+
+// Проходы выключенных в политике цветов не выполняются, у DefaultPolicy
+// проверки и вероятности - константы времени компиляции
+template <typename Policy, typename CheckBinding>
+void generate_layer_edges(const ColorPassLayers& layers,
+                          const Policy& policy,
+                          const CheckBinding& check_binding,
+                          const Seed& seed,
+                          int graph_index,
+                          LayerEdges& layer_edges) {
+  if (policy.is_color_enabled(Edge::Color::Green)) {
+    generate_green_edges(layers,
+                         policy.get_color_probability(Edge::Color::Green),
+                         seed, graph_index, layer_edges.green);
+  }
+  if (policy.is_color_enabled(Edge::Color::Yellow)) {
+    generate_yellow_edges(layers,
+                          policy.get_color_probability(Edge::Color::Yellow),
+                          check_binding, seed, graph_index,
+                          layer_edges.yellow);
+  }
+  if (policy.is_color_enabled(Edge::Color::Red)) {
+    generate_red_edges(layers, policy.get_color_probability(Edge::Color::Red),
+                       seed, graph_index, layer_edges.red);
+  }
+  if (policy.is_color_enabled(Edge::Color::Blue)) {
+    generate_blue_edges(layers, policy.get_color_probability(Edge::Color::Blue),
+                        seed, graph_index, layer_edges.blue);
+  }
+}
+
+// Позиция вершины в ее уровне. В режиме Layers id уровня идут подряд,
+// и позиция - это разность id, иначе строится таблица.
+class LayerPositions {
+ public:
+  LayerPositions(VertexIdSpan vertex_ids,
+                 std::pmr::memory_resource* memory_resource)
+      : vertex_ids_(vertex_ids),
+        is_contiguous_(
+            vertex_ids.empty() ||
+            (std::is_sorted(vertex_ids.begin(), vertex_ids.end()) &&
+             vertex_ids.back() - vertex_ids.front() + 1 == vertex_ids.size())),
+        positions_(memory_resource) {
+    if (!is_contiguous_) {
+      positions_.reserve(vertex_ids.size());
+      for (int idx = 0; idx < vertex_ids.size(); ++idx) {
+        positions_.emplace(vertex_ids[idx], idx);
+      }
+    }
+  }
+
+  int get_position(const VertexId& vertex_id) const {
+    return is_contiguous_ ? vertex_id - vertex_ids_.front()
+                          : positions_.at(vertex_id);
+  }
+
+ private:
+  const VertexIdSpan vertex_ids_;
+  const bool is_contiguous_;
+  std::pmr::unordered_map<VertexId, int> positions_;
+};
+
+// Ребра всех четырех цветов из уровня за один проход по его вершинам:
+// у каждого цвета свой курсор на следующий успех, поэтому случайные числа
+// и ребра те же, что у generate_layer_edges, а уровни d..d+2 читаются
+// один раз, пока они в кеше.
+// get_child_positions(vertex_id, positions) записывает отсортированные
+// позиции детей вершины на следующем уровне. Во время прохода между
+// соседними уровнями есть только серые ребра, поэтому желтое ребро
+// выбирается среди "не детей" без перебора уровня: случайный номер
+// сдвигается через позиции детей.
+template <typename Policy, typename GetChildPositions>
+void generate_layer_edges_fused(const ColorPassLayers& layers,
+                                const Policy& policy,
+                                const GetChildPositions& get_child_positions,
+                                const Seed& seed,
+                                int graph_index,
+                                LayerEdges& layer_edges) {
+  const Depth current_depth = layers.current_depth;
+  const auto& vertices_at_depth = layers.vertices_at_depth;
+  const auto& vertices_at_next_depth = layers.vertices_at_next_depth;
+  const auto& vertices_at_second_next_depth =
+      layers.vertices_at_second_next_depth;
+  const int layer_size = vertices_at_depth.size();
+  // Курсор выключенного цвета сразу стоит за концом уровня
+  const auto make_cursor = [&seed, graph_index, current_depth, layer_size](
+                               bool is_enabled, const Edge::Color& color,
+                               float probability) {
+    auto random_source =
+        get_layer_random_source(seed, graph_index, current_depth, color);
+    const int next_idx =
+        is_enabled ? random_source.get_geometric_skip(probability) : layer_size;
+    return std::pair{random_source, next_idx};
+  };
+  const float green_probability =
+      policy.get_color_probability(Edge::Color::Green);
+  const float blue_probability =
+      policy.get_color_probability(Edge::Color::Blue);
+  const float red_probability = policy.get_color_probability(Edge::Color::Red);
+  auto [green_random_source, next_green_idx] =
+      make_cursor(policy.is_color_enabled(Edge::Color::Green),
+                  Edge::Color::Green, green_probability);
+  // испытание на каждую пару соседних вершин уровня
+  auto [blue_random_source, next_blue_idx] = make_cursor(
+      policy.is_color_enabled(Edge::Color::Blue) && current_depth > 0,
+      Edge::Color::Blue, blue_probability);
+  auto [red_random_source, next_red_idx] = make_cursor(
+      policy.is_color_enabled(Edge::Color::Red) &&
+          current_depth < layers.graph_depth - 1,
+      Edge::Color::Red, red_probability);
+  LuckyMask yellow_mask(layer_edges.get_memory_resource());
+  if (policy.is_color_enabled(Edge::Color::Yellow) && current_depth > 0 &&
+      current_depth < layers.graph_depth) {
+    uni_cpp_practice::fill_lucky_mask(
+        seed, graph_index, Edge::Color::Yellow, vertices_at_depth,
+        get_yellow_edge_probability(
+            policy.get_color_probability(Edge::Color::Yellow), current_depth,
+            layers.graph_depth),
+        yellow_mask);
+  }
+  std::pmr::vector<int> child_positions(layer_edges.get_memory_resource());
+
+  for (int idx = 0; idx < layer_size; ++idx) {
+    const auto& vertex_id = vertices_at_depth[idx];
+    if (idx == next_green_idx) {
+      layer_edges.green.emplace_back(vertex_id, vertex_id);
+      next_green_idx +=
+          1 + green_random_source.get_geometric_skip(green_probability);
+    }
+    if (!yellow_mask.empty() &&
+        (yellow_mask[idx / 64] >> (idx % 64) & 1) != 0) {
+      auto random_source =
+          RandomSource(seed, {graph_index, vertex_id, Edge::Color::Yellow});
+      // первое число потока уже разыграно в маске
+      random_source.get_next_uint();
+      get_child_positions(vertex_id, child_positions);
+      const int candidates_count =
+          vertices_at_next_depth.size() - child_positions.size();
+      if (candidates_count > 0) {
+        int position = random_source.get_random_number(candidates_count);
+        for (const auto& child_position : child_positions) {
+          if (child_position <= position) {
+            ++position;
+          }
+        }
+        layer_edges.yellow.emplace_back(vertex_id,
+                                        vertices_at_next_depth[position]);
+      }
+    }
+    if (idx == next_red_idx) {
+      const int position = red_random_source.get_random_number(
+          vertices_at_second_next_depth.size());
+      layer_edges.red.emplace_back(vertex_id,
+                                   vertices_at_second_next_depth[position]);
+      next_red_idx += 1 + red_random_source.get_geometric_skip(red_probability);
+    }
+    if (idx == next_blue_idx && idx + 1 < layer_size) {
+      layer_edges.blue.emplace_back(vertex_id, vertices_at_depth[idx + 1]);
+      next_blue_idx +=
+          1 + blue_random_source.get_geometric_skip(blue_probability);
+    }
+  }
+}
+
+// Уровень графа в окне потоковой записи: id вершин уровня идут подряд,
+// parent_ids[i] - родитель вершины vertex_ids[i]
+struct StreamLayer {
+  std::vector<VertexId> vertex_ids;
+  std::pmr::vector<VertexId> parent_ids;
+  std::vector<Vertex> vertices;
+};
+
+Vertex& get_stream_vertex(std::deque<StreamLayer>& window,
+                          const VertexId& vertex_id) {
+  for (auto& layer : window) {
+    if (!layer.vertex_ids.empty() && layer.vertex_ids.front() <= vertex_id &&
+        vertex_id <= layer.vertex_ids.back()) {
+      return layer.vertices[vertex_id - layer.vertex_ids.front()];
+    }
+  }
+  assert(false && "Vertex isn't in window");
+  return window.front().vertices.front();
+}
+
+// Пишет граф в формате GraphPrinter::print по частям: вершины - сразу
+// в основной файл, ребра - во временный, который дописывается в конце
+class GraphFileWriter {
+ public:
+  GraphFileWriter(const std::string& file_path, const Depth& depth)
+      : edges_file_path_(file_path + ".edges"),
+        vertices_file_(file_path),
+        edges_file_(edges_file_path_) {
+    if (!vertices_file_ || !edges_file_) {
+      throw std::runtime_error("Failed to create file stream");
+    }
+    vertices_file_ << "{\n";
+    vertices_file_ << TAB << "\"depth\": " << depth << ",\n";
+    vertices_file_ << TAB << "\"vertices\": [\n";
+  }
+
+  void write_vertex(const Vertex& vertex) {
+    if (vertices_count_++ > 0) {
+      vertices_file_ << ", ";
+    }
+    vertices_file_ << GraphPrinter::print_vertex(vertex);
+  }
+
+  void write_edge(const Edge& edge) {
+    if (edges_count_++ > 0) {
+      edges_file_ << ", ";
+    }
+    edges_file_ << GraphPrinter::print_edge(edge);
+  }
+
+  void finish() {
+    edges_file_.close();
+    vertices_file_ << "\n" << TAB << "],\n";
+    vertices_file_ << TAB << "\"edges\": [\n";
+    if (edges_count_ > 0) {
+      vertices_file_ << std::ifstream(edges_file_path_).rdbuf();
+    }
+    std::filesystem::remove(edges_file_path_);
+    vertices_file_ << "\n" << TAB << "]\n";
+    vertices_file_ << "}" << std::endl;
+    if (!vertices_file_) {
+      throw std::runtime_error("Failed to write graph file");
+    }
+  }
+
+ private:
+  static constexpr const char* TAB = "    ";
+
+  const std::string edges_file_path_;
+  std::ofstream vertices_file_;
+  std::ofstream edges_file_;
+  int vertices_count_ = 0;
+  int edges_count_ = 0;
+};
+
+void add_edges(Graph& graph, const EdgeList& edges, const Edge::Color& color) {
+  for (const auto& [from_vertex_id, to_vertex_id] : edges) {
+    graph.add_edge(from_vertex_id, to_vertex_id, color);
+  }
+}
+// Политика Policy, в которой включены только цвета из is_enabled
+template <typename Policy>
+struct ColorMaskPolicy {
+  float get_color_probability(const Edge::Color& color) const {
+    return policy.get_color_probability(color);
+  }
+
+  bool is_color_enabled(const Edge::Color& color) const {
+    return is_enabled[int(color)] && policy.is_color_enabled(color);
+  }
+
+  const Policy& policy;
+  std::array<bool, COLORS_COUNT> is_enabled = {};
+};
+
+// Сколько потоков строят цветные ребра уровней графа от first_depth.
+// Маленький граф быстрее обработать в вызывающем потоке, чем запускать
+// потоки: их запуск дороже всей генерации.
+int get_colored_edges_threads_count(const Graph& graph,
+                                    const Depth& first_depth) {
+  return graph.get_vertex_map().size() < MIN_PARALLEL_LAYER_SIZE
+             ? 1
+             : std::min<int>(MAX_THREADS_COUNT,
+                             graph.get_depth() + 1 - first_depth);
+}
+
+// Цветные ребра строятся по исходным уровням: синие касаются только уровня d,
+// желтые - (d, d + 1), красные - (d, d + 2). Каждый из threads_count потоков
+// берет следующий необработанный уровень (начиная с глубоких, они крупнее)
+// и пишет в буферы этого уровня, граф во время прохода только читается.
+// Обрабатываются уровни от first_depth, get_layer_policy(depth) - политика
+// уровня depth. Буферы лежат в memory_resource, при нескольких потоках
+// он должен быть потокобезопасным.
+template <typename GetLayerPolicy>
+std::pmr::vector<LayerEdges> generate_colored_edges(
+    const Graph& graph,
+    const GetLayerPolicy& get_layer_policy,
+    const ColorKernel& color_kernel,
+    const Seed& seed,
+    int graph_index,
+    const Depth& first_depth,
+    int threads_count,
+    std::pmr::memory_resource* memory_resource) {
+  auto layers_edges =
+      std::pmr::vector<LayerEdges>(graph.get_depth() + 1, memory_resource);
+  std::atomic<Depth> next_depth = graph.get_depth();
+  const auto get_vertices_at_depth = [&graph](const Depth& depth) {
+    return depth <= graph.get_depth() ? graph.get_vertices_at_depth(depth)
+                                      : VertexIdSpan();
+  };
+  const auto check_binding = [&graph](const VertexId& from_vertex_id,
+                                      const VertexId& to_vertex_id) {
+    return graph.check_binding(from_vertex_id, to_vertex_id);
+  };
+  const auto worker = [&graph, &get_layer_policy, &color_kernel, &seed,
+                       graph_index, &layers_edges, &next_depth, &first_depth,
+                       &get_vertices_at_depth, &check_binding]() {
+    for (Depth depth = next_depth--; depth >= first_depth;
+         depth = next_depth--) {
+      const auto policy = get_layer_policy(depth);
+      const auto layers = ColorPassLayers{
+          graph.get_depth(), depth, get_vertices_at_depth(depth),
+          get_vertices_at_depth(depth + 1), get_vertices_at_depth(depth + 2)};
+      if (color_kernel == ColorKernel::Passes) {
+        generate_layer_edges(layers, policy, check_binding, seed, graph_index,
+                             layers_edges[depth]);
+        continue;
+      }
+      // Дети вершины - ее серые соседи с большим id: родитель всегда
+      // создается раньше ребенка
+      const auto next_layer_positions =
+          LayerPositions(layers.vertices_at_next_depth,
+                         layers_edges[depth].get_memory_resource());
+      const auto get_child_positions =
+          [&graph, &next_layer_positions](const VertexId& vertex_id,
+                                          std::pmr::vector<int>& positions) {
+            positions.clear();
+            for (const auto& neighbor :
+                 graph.get_vertex(vertex_id).get_neighbors()) {
+              if (neighbor.color == Edge::Color::Gray &&
+                  neighbor.vertex_id > vertex_id) {
+                positions.push_back(
+                    next_layer_positions.get_position(neighbor.vertex_id));
+              }
+            }
+            std::sort(positions.begin(), positions.end());
+          };
+      generate_layer_edges_fused(layers, policy, get_child_positions, seed,
+                                 graph_index, layers_edges[depth]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < threads_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return layers_edges;
+}
+
+// Ребра уровней в фиксированном порядке: по цветам, внутри цвета -
+// по уровням
+template <typename Callback>
+void for_each_colored_edge_list(
+    const std::pmr::vector<LayerEdges>& layers_edges,
+    const Callback& callback) {
+  for (const auto& layer_edges : layers_edges) {
+    callback(layer_edges.green, Edge::Color::Green);
+  }
+  for (const auto& layer_edges : layers_edges) {
+    callback(layer_edges.yellow, Edge::Color::Yellow);
+  }
+  for (const auto& layer_edges : layers_edges) {
+    callback(layer_edges.red, Edge::Color::Red);
+  }
+  for (const auto& layer_edges : layers_edges) {
+    callback(layer_edges.blue, Edge::Color::Blue);
+  }
+}
+
+template <typename GetLayerPolicy>
+void add_colored_edges(Graph& graph,
+                       const GetLayerPolicy& get_layer_policy,
+                       const ColorKernel& color_kernel,
+                       const Seed& seed,
+                       int graph_index,
+                       const Depth& first_depth = 0) {
+  // Буферы ребер лежат в ресурсе графа, несколько потоков берут из него
+  // память по очереди
+  const int threads_count =
+      get_colored_edges_threads_count(graph, first_depth);
+  auto synchronized_resource =
+      SynchronizedResource(graph.get_memory_resource());
+  const auto layers_edges = generate_colored_edges(
+      graph, get_layer_policy, color_kernel, seed, graph_index, first_depth,
+      threads_count,
+      threads_count > 1 ? &synchronized_resource
+                        : graph.get_memory_resource());
+  for_each_colored_edge_list(
+      layers_edges, [&graph](const EdgeList& edges, const Edge::Color& color) {
+        add_edges(graph, edges, color);
+      });
+}
+}  // namespace
+
+namespace uni_cpp_practice {
+
+int GraphStats::count_vertices() const {
+  return std::accumulate(vertices_at_depth.begin(), vertices_at_depth.end(),
+                         0);
+}
+
+int GraphStats::count_edges() const {
+  int edges_count = 0;
+  for (const auto& [color, count] : edges_of_color) {
+    edges_count += count;
+  }
+  return edges_count;
+}
+
+int GraphStats::count_edges_of_color(const Edge::Color& color) const {
+  const auto it = edges_of_color.find(color);
+  return it == edges_of_color.end() ? 0 : it->second;
+}
+
+Graph GraphBatch::get_graph(int idx,
+                            std::pmr::memory_resource* memory_resource) const {
+  const int first_vertex_idx = vertices_offsets[idx];
+  const int last_vertex_idx = vertices_offsets[idx + 1];
+  const int first_edge_idx = edges_offsets[idx];
+  const int last_edge_idx = edges_offsets[idx + 1];
+  auto graph = Graph(memory_resource);
+  graph.reserve(last_vertex_idx - first_vertex_idx,
+                last_edge_idx - first_edge_idx,
+                vertex_depths[last_vertex_idx - 1]);
+  graph.set_validation_mode(validation_mode);
+  graph.add_vertex();
+  // Серые ребра идут в порядке id детей, поэтому уровни восстанавливаются
+  // через add_layer, как в generate
+  std::vector<VertexId> child_parent_ids;
+  int edge_idx = first_edge_idx;
+  for (int vertex_idx = first_vertex_idx + 1; vertex_idx < last_vertex_idx;
+       ++vertex_idx, ++edge_idx) {
+    child_parent_ids.push_back(edge_from_vertex_ids[edge_idx]);
+    if (vertex_idx + 1 == last_vertex_idx ||
+        vertex_depths[vertex_idx + 1] != vertex_depths[vertex_idx]) {
+      graph.add_layer(child_parent_ids);
+      child_parent_ids.clear();
+    }
+  }
+  for (; edge_idx < last_edge_idx; ++edge_idx) {
+    graph.add_edge(edge_from_vertex_ids[edge_idx],
+                   edge_to_vertex_ids[edge_idx], edge_colors[edge_idx]);
+  }
+  return graph;
+}
+
+template <typename Policy>
+BasicGraphGenerator<Policy>::BasicGraphGenerator(const Params& params,
+                                                 const Policy& policy)
+    : params_(params),
+      policy_(policy),
+      seed_(params.seed.value_or(get_random_seed())),
+      attachment_edges_per_vertex_(
+          params.gray_mode == GrayMode::PreferentialAttachment
+              ? get_attachment_edges_per_vertex()
+              : 0),
+      target_plan_(make_target_plan()),
+      size_estimate_(make_size_estimate()) {
+  if (params_.size_target && params_.gray_mode == GrayMode::Branches) {
+    throw std::invalid_argument(
+        "size_target is not supported in Branches mode");
+  }
+  if (params_.gray_mode == GrayMode::PreferentialAttachment) {
+    const auto estimate = estimate_size();
+    if (estimate.vertices_count > MAX_ATTACHMENT_VERTICES_COUNT ||
+        estimate.edges_count_bound > std::numeric_limits<int>::max()) {
+      throw std::invalid_argument(
+          "Graph is too large for PreferentialAttachment mode");
+    }
+  }
+}
+
+template <typename Policy>
+typename BasicGraphGenerator<Policy>::TargetPlan
+BasicGraphGenerator<Policy>::make_vertices_target_plan(
+    double vertices_count) const {
+  auto plan = TargetPlan();
+  plan.vertices_count = std::clamp<double>(
+      std::round(vertices_count), 1, std::numeric_limits<int>::max());
+  plan.new_vertices_num = std::max(1, params_.new_vertices_num);
+  if (params_.depth <= 0) {
+    plan.vertices_count = 1;
+    return plan;
+  }
+  const double probability = policy_.get_color_probability(Edge::Color::Gray);
+  while (1 + get_descendants_mean(plan.new_vertices_num,
+                                  probability / TARGET_HEADROOM, 0,
+                                  params_.depth) <
+             plan.vertices_count &&
+         plan.new_vertices_num < plan.vertices_count) {
+    ++plan.new_vertices_num;
+  }
+  plan.probability_scale =
+      find_probability_scale(plan.new_vertices_num, probability, 0,
+                             params_.depth, 1, plan.vertices_count - 1);
+  return plan;
+}
+
+template <typename Policy>
+std::optional<typename BasicGraphGenerator<Policy>::TargetPlan>
+BasicGraphGenerator<Policy>::make_target_plan() const {
+  if (!params_.size_target) {
+    return std::nullopt;
+  }
+  const auto& size_target = *params_.size_target;
+  if (params_.gray_mode == GrayMode::PreferentialAttachment) {
+    // Расписания нет: дерево просто растет до нужного числа вершин
+    auto plan = TargetPlan();
+    plan.vertices_count = std::max<double>(
+        1, std::round(size_target.kind == SizeTarget::Kind::Vertices
+                          ? size_target.count
+                          : size_target.count / attachment_edges_per_vertex_));
+    return plan;
+  }
+  if (size_target.kind == SizeTarget::Kind::Vertices) {
+    return make_vertices_target_plan(size_target.count);
+  }
+  // Число ребер на вершину зависит от формы дерева: сначала план строится
+  // по оценке снизу (каждый цвет у каждой вершины), затем уточняется
+  // по средним размерам уровней этого плана
+  double colored_probabilities_sum = 0;
+  for (const auto& color : {Edge::Color::Green, Edge::Color::Blue,
+                            Edge::Color::Yellow, Edge::Color::Red}) {
+    colored_probabilities_sum += policy_.get_color_probability(color);
+  }
+  const auto plan =
+      make_vertices_target_plan(size_target.count /
+                                (1 + colored_probabilities_sum));
+  const double probability = plan.probability_scale *
+                             policy_.get_color_probability(Edge::Color::Gray);
+  std::vector<double> layer_means = {1};
+  for (Depth current_depth = 0; current_depth < params_.depth;
+       ++current_depth) {
+    layer_means.push_back(
+        layer_means.back() * plan.new_vertices_num * probability *
+        (1 - double(current_depth) / double(params_.depth)));
+  }
+  const double vertices_count =
+      std::accumulate(layer_means.begin(), layer_means.end(), 0.0);
+  const double edges_per_vertex =
+      get_edges_mean(policy_, layer_means, vertices_count) / vertices_count;
+  return make_vertices_target_plan(size_target.count / edges_per_vertex);
+}
+
+template <typename Policy>
+BinomialDistribution
+BasicGraphGenerator<Policy>::get_children_count_distribution(
+    const Depth& depth) const {
+  return get_children_count_distribution(depth, params_.depth);
+}
+
+template <typename Policy>
+BinomialDistribution
+BasicGraphGenerator<Policy>::get_children_count_distribution(
+    const Depth& depth,
+    const Depth& max_depth) const {
+  const float probability =
+      policy_.get_color_probability(Edge::Color::Gray) *
+      (target_plan_ ? target_plan_->probability_scale : 1);
+  return BinomialDistribution(
+      get_new_vertices_num(),
+      probability * (1 - (float(depth) / float(max_depth))));
+}
+
+template <typename Policy>
+BinomialDistribution
+BasicGraphGenerator<Policy>::get_layer_children_distribution(
+    const Depth& parent_depth,
+    int parents_count,
+    int vertices_budget) const {
+  if (!target_plan_) {
+    return get_children_count_distribution(parent_depth);
+  }
+  // Расписание оставшихся уровней подстраивается так, чтобы у уровня
+  // в среднем было столько потомков, сколько осталось в бюджете
+  const float probability = policy_.get_color_probability(Edge::Color::Gray);
+  const double probability_scale = find_probability_scale(
+      target_plan_->new_vertices_num, probability, parent_depth,
+      params_.depth, parents_count,
+      TARGET_OVERSHOOT * vertices_budget);
+  return BinomialDistribution(
+      target_plan_->new_vertices_num,
+      probability_scale * probability *
+          (1 - (float(parent_depth) / float(params_.depth))));
+}
+
+template <typename Policy>
+int BasicGraphGenerator<Policy>::get_vertices_budget(
+    const Depth& parent_depth,
+    const std::vector<int>& layer_sizes) const {
+  if (!target_plan_) {
+    return std::numeric_limits<int>::max();
+  }
+  const int vertices_count =
+      std::accumulate(layer_sizes.begin(),
+                      layer_sizes.begin() + parent_depth + 1, 0);
+  const auto& size_target = *params_.size_target;
+  if (size_target.kind == SizeTarget::Kind::Vertices) {
+    return std::max(0, target_plan_->vertices_count - vertices_count);
+  }
+  // Оставшиеся уровни разыгрываются с множителем вероятностей, при
+  // котором в среднем получается TARGET_OVERSHOOT * бюджет вершин, и
+  // ожидаемое число ребер растет с множителем. Поэтому двоичным поиском
+  // ищется множитель, а бюджет получается из него. Серых ребер на одно
+  // меньше, чем вершин, так что вершин не больше count + 1.
+  const int max_budget = std::max(0, size_target.count + 1 - vertices_count);
+  const float probability = policy_.get_color_probability(Edge::Color::Gray);
+  const auto get_budget = [this, &parent_depth, &layer_sizes, probability,
+                           max_budget](double probability_scale) {
+    return std::min<double>(
+        max_budget, layer_sizes[parent_depth] *
+                        get_descendants_mean(target_plan_->new_vertices_num,
+                                             probability_scale * probability,
+                                             parent_depth, params_.depth) /
+                        TARGET_OVERSHOOT);
+  };
+  const auto is_below_target = [this, &parent_depth, &layer_sizes,
+                                &get_budget,
+                                &size_target](double probability_scale) {
+    return get_target_edges_mean(parent_depth, layer_sizes, probability_scale,
+                                 get_budget(probability_scale)) <
+           size_target.count;
+  };
+  // Даже без множителя цель не достигается: дерево растет, сколько может
+  if (is_below_target(1)) {
+    return max_budget;
+  }
+  // Бюджет целый: поиск останавливается, когда он уже не меняется
+  double low_scale = 0;
+  double high_scale = 1;
+  for (int step = 0; step < PROBABILITY_SCALE_SEARCH_STEPS &&
+                     get_budget(high_scale) - get_budget(low_scale) > 1;
+       ++step) {
+    const double scale = (low_scale + high_scale) / 2;
+    (is_below_target(scale) ? low_scale : high_scale) = scale;
+  }
+  return std::ceil(get_budget(high_scale));
+}
+
+template <typename Policy>
+double BasicGraphGenerator<Policy>::get_target_edges_mean(
+    const Depth& parent_depth,
+    const std::vector<int>& layer_sizes,
+    double probability_scale,
+    double vertices_budget) const {
+  std::vector<double> layer_means(layer_sizes.begin(),
+                                  layer_sizes.begin() + parent_depth + 1);
+  double vertices_count =
+      std::accumulate(layer_means.begin(), layer_means.end(), 0.0);
+  // То, что не влезает в бюджет, отрезается, как при генерации. Без этого
+  // дерево заканчивается раньше ожидаемой глубины, а у неглубокого дерева
+  // больше желтых ребер.
+  const float probability = policy_.get_color_probability(Edge::Color::Gray);
+  double remaining_budget = vertices_budget;
+  for (Depth current_depth = parent_depth;
+       current_depth < params_.depth && remaining_budget > 0;
+       ++current_depth) {
+    const double layer_mean = std::min(
+        remaining_budget, layer_means.back() * target_plan_->new_vertices_num *
+                              probability_scale * probability *
+                              (1 - double(current_depth) /
+                                       double(params_.depth)));
+    layer_means.push_back(layer_mean);
+    vertices_count += layer_mean;
+    remaining_budget -= layer_mean;
+  }
+  return get_edges_mean(policy_, layer_means, vertices_count);
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::generate_gray_layer(
+    VertexIdSpan parent_ids,
+    const BinomialDistribution& distribution,
+    int graph_index,
+    std::pmr::vector<VertexId>& child_parent_ids) const {
+  std::pmr::vector<int> children_counts(parent_ids.size(),
+                                        child_parent_ids.get_allocator());
+
+  // Каждый поток разыгрывает число детей для своего куска уровня.
+  // Потоки ключуются глобальным id родителя, поэтому результат
+  // не зависит от разбиения на куски.
+  std::array<int, MAX_THREADS_COUNT> chunk_children_counts = {};
+  for_each_chunk(
+      parent_ids.size(),
+      [this, graph_index, &parent_ids, &distribution, &children_counts,
+       &chunk_children_counts](int chunk_index, int first_idx, int last_idx) {
+        int chunk_children_count = 0;
+        for (int idx = first_idx; idx < last_idx; ++idx) {
+          auto random_source = RandomSource(
+              seed_, {graph_index, parent_ids[idx], Edge::Color::Gray});
+          children_counts[idx] = random_source.get_binomial(distribution);
+          chunk_children_count += children_counts[idx];
+        }
+        chunk_children_counts[chunk_index] = chunk_children_count;
+      });
+
+  // Исключающая префиксная сумма по кускам: с какого места следующего
+  // уровня начинаются дети каждого куска
+  std::array<int, MAX_THREADS_COUNT> chunk_first_child_idx;
+  std::exclusive_scan(chunk_children_counts.begin(),
+                      chunk_children_counts.end(),
+                      chunk_first_child_idx.begin(), 0);
+  child_parent_ids.resize(chunk_first_child_idx.back() +
+                          chunk_children_counts.back());
+  if (child_parent_ids.empty()) {
+    return;
+  }
+
+  // Потоки пишут в свои непересекающиеся ячейки без блокировок
+  for_each_chunk(
+      parent_ids.size(),
+      [&parent_ids, &children_counts, &chunk_first_child_idx,
+       &child_parent_ids](int chunk_index, int first_idx, int last_idx) {
+        int child_idx = chunk_first_child_idx[chunk_index];
+        for (int idx = first_idx; idx < last_idx; ++idx) {
+          std::fill_n(child_parent_ids.begin() + child_idx,
+                      children_counts[idx], parent_ids[idx]);
+          child_idx += children_counts[idx];
+        }
+      });
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::generate_next_gray_layer(
+    VertexIdSpan parent_ids,
+    const Depth& parent_depth,
+    const std::vector<int>& layer_sizes,
+    int graph_index,
+    std::pmr::vector<VertexId>& child_parent_ids) const {
+  // Бюджет и параметры распределения считаются один раз на уровень
+  const int vertices_budget = get_vertices_budget(parent_depth, layer_sizes);
+  generate_gray_layer(parent_ids,
+                      get_layer_children_distribution(
+                          parent_depth, parent_ids.size(), vertices_budget),
+                      graph_index, child_parent_ids);
+  if (int(child_parent_ids.size()) > vertices_budget) {
+    child_parent_ids.resize(vertices_budget);
+  }
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::generate_gray_layers(Graph& graph,
+                                                       int graph_index) const {
+  // Родитель каждого ребенка следующего уровня, в порядке обхода в ширину
+  std::pmr::vector<VertexId> child_parent_ids(graph.get_memory_resource());
+  std::vector<int> layer_sizes = {1};
+  for (Depth current_depth = 0; current_depth < params_.depth;
+       ++current_depth) {
+    // Уровень действителен до add_layer
+    generate_next_gray_layer(graph.get_vertices_at_depth(current_depth),
+                             current_depth, layer_sizes, graph_index,
+                             child_parent_ids);
+    if (child_parent_ids.empty()) {
+      break;
+    }
+    layer_sizes.push_back(child_parent_ids.size());
+    // id детей идут подряд: первый ребенок уровня + индекс в уровне
+    graph.add_layer(child_parent_ids);
+  }
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::generate_batch_gray_layers(
+    std::vector<BatchLane>& lanes,
+    int lanes_count) const {
+  for (int lane_idx = 0; lane_idx < lanes_count; ++lane_idx) {
+    auto& lane = lanes[lane_idx];
+    lane.depth = 0;
+    if (lane.layers.empty()) {
+      lane.layers.emplace_back();
+    }
+    lane.layers[0].assign(1, 0);
+    lane.parent_ids.assign(1, NO_PARENT);
+    lane.first_child_ids.clear();
+  }
+  // Потоки вершин уровня всех графов, которые еще растут
+  std::vector<int> graph_indices;
+  std::vector<VertexId> vertex_ids;
+  std::vector<std::uint32_t> random_uints;
+  std::vector<int> layer_sizes;
+  for (Depth depth = 0; depth < params_.depth; ++depth) {
+    graph_indices.clear();
+    vertex_ids.clear();
+    for (int lane_idx = 0; lane_idx < lanes_count; ++lane_idx) {
+      const auto& lane = lanes[lane_idx];
+      if (lane.depth == depth) {
+        const auto& parent_ids = lane.layers[depth];
+        graph_indices.insert(graph_indices.end(), parent_ids.size(),
+                             lane.graph_index);
+        vertex_ids.insert(vertex_ids.end(), parent_ids.begin(),
+                          parent_ids.end());
+      }
+    }
+    if (vertex_ids.empty()) {
+      break;
+    }
+    // Те же числа, что и у RandomSource в generate_gray_layer
+    fill_first_uints(seed_, Edge::Color::Gray, graph_indices, vertex_ids,
+                     random_uints);
+    // Без size_target распределение одно на уровень у всех графов
+    const auto shared_distribution =
+        target_plan_ ? std::nullopt
+                     : std::optional(get_children_count_distribution(depth));
+    int stream_idx = 0;
+    for (int lane_idx = 0; lane_idx < lanes_count; ++lane_idx) {
+      auto& lane = lanes[lane_idx];
+      if (lane.depth != depth) {
+        continue;
+      }
+      if (Depth(lane.layers.size()) == depth + 1) {
+        lane.layers.emplace_back();
+      }
+      const auto& parent_ids = lane.layers[depth];
+      auto& child_ids = lane.layers[depth + 1];
+      child_ids.clear();
+      const int vertices_count = lane.parent_ids.size();
+      // Дети сверх бюджета отбрасываются, как в generate_next_gray_layer
+      int vertices_budget = std::numeric_limits<int>::max();
+      if (target_plan_) {
+        layer_sizes.clear();
+        for (Depth layer_depth = 0; layer_depth <= depth; ++layer_depth) {
+          layer_sizes.push_back(lane.layers[layer_depth].size());
+        }
+        vertices_budget = get_vertices_budget(depth, layer_sizes);
+      }
+      const auto distribution =
+          shared_distribution ? *shared_distribution
+                              : get_layer_children_distribution(
+                                    depth, parent_ids.size(), vertices_budget);
+      for (const auto& parent_id : parent_ids) {
+        lane.first_child_ids.push_back(vertices_count + child_ids.size());
+        const int children_count =
+            std::min<int>(get_binomial(distribution, random_uints[stream_idx]),
+                          vertices_budget - child_ids.size());
+        ++stream_idx;
+        for (int i = 0; i < children_count; ++i) {
+          child_ids.push_back(vertices_count + child_ids.size());
+          lane.parent_ids.push_back(parent_id);
+        }
+      }
+      if (!child_ids.empty()) {
+        lane.depth = depth + 1;
+      }
+    }
+  }
+  // У вершин последнего уровня детей нет
+  for (int lane_idx = 0; lane_idx < lanes_count; ++lane_idx) {
+    auto& lane = lanes[lane_idx];
+    lane.first_child_ids.resize(lane.parent_ids.size() + 1,
+                                lane.parent_ids.size());
+  }
+}
+
+template <typename Policy>
+double BasicGraphGenerator<Policy>::get_attachment_edges_per_vertex() const {
+  return get_edges_mean(policy_, get_attachment_pilot_layer_means(),
+                        ATTACHMENT_PILOT_VERTICES_COUNT) /
+         ATTACHMENT_PILOT_VERTICES_COUNT;
+}
+
+template <typename Policy>
+int BasicGraphGenerator<Policy>::get_attachment_vertices_count(
+    const std::vector<VertexId>& parent_ids,
+    double edges_count) const {
+  // Первые вершины дерева - это дерево меньшего размера с тем же seed,
+  // поэтому ожидаемое число ребер считается по фактическим размерам
+  // уровней каждого префикса: сначала шагами, затем по одной вершине
+  // внутри последнего шага
+  const int max_vertices_count = parent_ids.size();
+  const int step = std::max(1, max_vertices_count / ATTACHMENT_SEARCH_STEPS);
+  std::vector<Depth> depths(max_vertices_count, 0);
+  std::vector<double> layer_sizes = {1};
+  int vertices_count = 1;
+  const auto add_next_vertex = [&parent_ids, &depths, &layer_sizes,
+                                &vertices_count]() {
+    const VertexId vertex_id = vertices_count++;
+    depths[vertex_id] = depths[parent_ids[vertex_id]] + 1;
+    if (depths[vertex_id] == Depth(layer_sizes.size())) {
+      layer_sizes.push_back(0);
+    }
+    ++layer_sizes[depths[vertex_id]];
+  };
+  const auto is_below_target = [this, &layer_sizes, &vertices_count,
+                                edges_count]() {
+    return get_edges_mean(policy_, layer_sizes, vertices_count) < edges_count;
+  };
+
+  auto step_begin_layer_sizes = layer_sizes;
+  int step_begin = vertices_count;
+  while (vertices_count < max_vertices_count && is_below_target()) {
+    step_begin_layer_sizes = layer_sizes;
+    step_begin = vertices_count;
+    const int step_end = std::min(max_vertices_count, vertices_count + step);
+    while (vertices_count < step_end) {
+      add_next_vertex();
+    }
+  }
+  if (is_below_target()) {
+    return vertices_count;
+  }
+  layer_sizes = std::move(step_begin_layer_sizes);
+  vertices_count = step_begin;
+  while (is_below_target()) {
+    add_next_vertex();
+  }
+  return vertices_count;
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::generate_attachment_tree(
+    Graph& graph,
+    int graph_index,
+    int max_vertices_count) const {
+  auto parent_ids =
+      get_attachment_parent_ids(seed_, graph_index, max_vertices_count);
+  if (params_.size_target &&
+      params_.size_target->kind == SizeTarget::Kind::Edges) {
+    parent_ids.resize(get_attachment_vertices_count(
+        parent_ids, params_.size_target->count));
+  }
+  const int vertices_count = parent_ids.size();
+
+  // Вершины перенумеровываются в порядке обхода в ширину, как в режиме
+  // Layers: дети вершины идут подряд, и дерево строится по уровням
+  std::vector<int> first_child_idx(vertices_count + 1, 0);
+  for (VertexId vertex_id = 1; vertex_id < vertices_count; ++vertex_id) {
+    ++first_child_idx[parent_ids[vertex_id] + 1];
+  }
+  std::partial_sum(first_child_idx.begin(), first_child_idx.end(),
+                   first_child_idx.begin());
+  std::vector<VertexId> children(vertices_count - 1);
+  {
+    auto next_child_idx = first_child_idx;
+    for (VertexId vertex_id = 1; vertex_id < vertices_count; ++vertex_id) {
+      children[next_child_idx[parent_ids[vertex_id]]++] = vertex_id;
+    }
+  }
+  // order[i] - старый номер вершины с новым id i
+  std::vector<VertexId> order = {0};
+  order.reserve(vertices_count);
+  std::vector<VertexId> child_parent_ids;
+  int layer_begin = 0;
+  while (layer_begin < int(order.size())) {
+    const int layer_end = order.size();
+    child_parent_ids.clear();
+    for (int idx = layer_begin; idx < layer_end; ++idx) {
+      for (int child_idx = first_child_idx[order[idx]];
+           child_idx < first_child_idx[order[idx] + 1]; ++child_idx) {
+        order.push_back(children[child_idx]);
+        child_parent_ids.push_back(idx);
+      }
+    }
+    graph.add_layer(child_parent_ids);
+    layer_begin = layer_end;
+  }
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::generate_gray_branch(GrayBranch& branch,
+                                                       int graph_index,
+                                                       int branch_index) const {
+  // Обход в глубину без рекурсии: в стеке лежат еще не обработанные дети
+  // вершин текущего пути, поэтому его размер не больше глубины ветви
+  std::vector<PendingChildren> pending_stack;
+  // Распределения числа детей по глубинам, считаются при первом обращении,
+  // так что память зависит от достигнутой глубины, а не от params_.depth
+  std::vector<BinomialDistribution> children_count_distributions;
+  // Корень ветви - единственный ребенок нулевой вершины в этой ветви
+  branch.children.emplace_back(NO_PARENT, 1);
+  branch.vertices_count = 1;
+  pending_stack.push_back({0, 1, 1});
+  while (!pending_stack.empty()) {
+    auto& pending_children = pending_stack.back();
+    if (pending_children.next_local_id == pending_children.end_local_id) {
+      pending_stack.pop_back();
+      continue;
+    }
+    const int local_id = pending_children.next_local_id++;
+    const Depth current_depth = pending_children.depth;
+    assert(current_depth <= params_.depth && "Depth error");
+    if (current_depth == params_.depth) {
+      continue;
+    }
+    // Глобальных id у вершин ветви ещё нет, поэтому поток определяется
+    // номером ветви (scope) и локальным номером вершины
+    auto random_source = RandomSource(
+        seed_, {graph_index, local_id, Edge::Color::Gray, branch_index + 1});
+    while (Depth(children_count_distributions.size()) <= current_depth) {
+      children_count_distributions.push_back(get_children_count_distribution(
+          children_count_distributions.size()));
+    }
+    // Вместо new_vertices_num испытаний - одна выборка числа детей
+    const int children_count = random_source.get_binomial(
+        children_count_distributions[current_depth]);
+    if (children_count == 0) {
+      continue;
+    }
+    const int first_child_local_id = branch.vertices_count;
+    branch.children.emplace_back(local_id, children_count);
+    branch.vertices_count += children_count;
+    pending_stack.push_back({first_child_local_id,
+                             first_child_local_id + children_count,
+                             current_depth + 1});
+  }
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::generate_gray_edges(
+    Graph& graph,
+    int graph_index,
+    const VertexId& parent_vertex_id) const {
+  // Job - это lambda функция,
+  // которая энкапсулирует в себе генерацию однйо ветви
+  using JobCallback = std::function<void()>;
+  auto jobs = std::list<JobCallback>();
+
+  // Заполняем список работ для воркеров.
+  // Каждая ветвь строится в своем буфере, поэтому блокировка не нужна.
+  std::atomic<int> jobs_counter = 0;
+  auto branches = std::vector<GrayBranch>(params_.new_vertices_num);
+  for (int i = 0; i < params_.new_vertices_num; i++) {
+    jobs.emplace_back([this, &branches, &jobs_counter, graph_index, i]() {
+      generate_gray_branch(branches[i], graph_index, i);
+      ++jobs_counter;
+    });
+  }
+
+  // Создаем воркера,
+  // который в бесконечном цикле проверяет,
+  // есть ли работа, и выполняет её
+  std::mutex mutex_jobs;
+  std::atomic<bool> should_terminate = false;
+  const auto worker = [&should_terminate, &mutex_jobs, &jobs]() {
+    while (true) {
+      // Проверка флага, должны ли мы остановить поток
+      if (should_terminate) {
+        return;
+      }
+      // Проверяем, есть ли для нас работа
+      const auto job_optional = [&mutex_jobs,
+                                 &jobs]() -> std::optional<JobCallback> {
+        const std::lock_guard lock(mutex_jobs);
+        if (jobs.empty()) {
+          return std::nullopt;
+        }
+        const auto first_job = jobs.front();
+        jobs.pop_front();
+        return first_job;
+      }();
+      if (job_optional.has_value()) {
+        // Работа есть, выполняем её
+        const auto& job = job_optional.value();
+        job();
+      }
+    }
+  };
+
+  // Создаем и запускаем потоки с воркерами
+  // MAX_THREADS_COUNT = 4
+  std::array<std::thread, MAX_THREADS_COUNT> threads;
+  for (int i = 0; i < MAX_THREADS_COUNT; ++i) {
+    threads[i] = std::thread(worker);
+  }
+
+  // Ждем, когда все ветви будут сгенерированы
+  while (jobs_counter < params_.new_vertices_num) {
+  }
+
+  // Останавливем всех воркеров и потоки
+  should_terminate = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Добавляем ветви в граф по порядку, группами детей: вершины ветви
+  // получают подряд идущие id, поэтому id = id корня ветви + локальный номер
+  for (const auto& branch : branches) {
+    VertexId branch_root_id = 0;
+    for (const auto& [parent_local_id, children_count] : branch.children) {
+      if (parent_local_id == NO_PARENT) {
+        branch_root_id = graph.add_children(parent_vertex_id, children_count);
+      } else {
+        graph.add_children(branch_root_id + parent_local_id, children_count);
+      }
+    }
+  }
+}
+
+template <typename Policy>
+GraphSizeEstimate BasicGraphGenerator<Policy>::make_size_estimate() const {
+  const Depth depth =
+      params_.depth > 0 && get_new_vertices_num() > 0 ? params_.depth : 0;
+  // Для уровня d: среднее и дисперсия его размера, среднее число детей
+  // вершины и наибольший возможный размер
+  std::vector<double> layer_means = {1};
+  std::vector<double> layer_variances = {0};
+  std::vector<double> children_means;
+  double max_layer_size = 1;
+  double max_vertices_count = 1;
+  for (Depth current_depth = 0; current_depth < depth; ++current_depth) {
+    const auto distribution = get_children_count_distribution(current_depth);
+    const double children_mean =
+        distribution.trials * double(distribution.probability);
+    const double children_variance =
+        children_mean * (1 - double(distribution.probability));
+    // Var(L') = E(L) * Var(дети) + Var(L) * E(дети)^2
+    layer_variances.push_back(
+        layer_means.back() * children_variance +
+        layer_variances.back() * children_mean * children_mean);
+    layer_means.push_back(layer_means.back() * children_mean);
+    children_means.push_back(children_mean);
+    max_layer_size = children_mean > 0 ? max_layer_size * distribution.trials
+                                       : 0;
+    max_vertices_count += max_layer_size;
+  }
+
+  // Уровни одного дерева зависимы: Cov(L_i, L_j) = Var(L_i) * произведение
+  // средних чисел детей на глубинах i..j-1. descendants_mean - сумма этих
+  // произведений по всем j > i.
+  double vertices_count = 0;
+  double vertices_variance = 0;
+  double descendants_mean = 0;
+  for (Depth current_depth = depth; current_depth >= 0; --current_depth) {
+    descendants_mean = current_depth < depth
+                           ? children_means[current_depth] *
+                                 (1 + descendants_mean)
+                           : 0;
+    vertices_count += layer_means[current_depth];
+    vertices_variance +=
+        layer_variances[current_depth] * (1 + 2 * descendants_mean);
+  }
+
+  double edges_count = get_edges_mean(policy_, layer_means, vertices_count);
+  if (target_plan_) {
+    // Бюджет обрезает дерево ровно до цели
+    edges_count *= target_plan_->vertices_count / vertices_count;
+    vertices_count = target_plan_->vertices_count;
+    vertices_variance = 0;
+    max_vertices_count = vertices_count;
+  }
+
+  auto estimate = GraphSizeEstimate();
+  estimate.vertices_count = vertices_count;
+  estimate.edges_count = edges_count;
+  estimate.vertices_count_bound = std::min(
+      vertices_count + ESTIMATE_BOUND_DEVIATIONS * std::sqrt(vertices_variance),
+      max_vertices_count);
+  // Ребер на вершину в среднем столько же и у больших графов, а разброс
+  // самих цветных ребер при известных уровнях - не больше пуассоновского
+  estimate.edges_count_bound =
+      edges_count * estimate.vertices_count_bound / vertices_count +
+      ESTIMATE_BOUND_DEVIATIONS * std::sqrt(edges_count);
+  if (params_.gray_mode == GrayMode::Layers && params_.size_target &&
+      params_.size_target->kind == SizeTarget::Kind::Edges) {
+    // Бюджет вершин решается по ребрам, поэтому вершин получается
+    // столько, сколько нужно форме конкретного дерева, а от цели
+    // отклоняются только цветные ребра
+    estimate.edges_count = params_.size_target->count;
+    estimate.vertices_count_bound =
+        std::min(std::ceil(TARGET_VERTICES_HEADROOM * vertices_count),
+                 estimate.edges_count + 1);
+    estimate.edges_count_bound =
+        estimate.edges_count +
+        ESTIMATE_BOUND_DEVIATIONS * std::sqrt(estimate.edges_count);
+  }
+  if (params_.gray_mode == GrayMode::PreferentialAttachment) {
+    estimate.vertices_count = std::round(vertices_count);
+    estimate.vertices_count_bound = estimate.vertices_count;
+    const bool is_edges_target =
+        params_.size_target &&
+        params_.size_target->kind == SizeTarget::Kind::Edges;
+    if (is_edges_target) {
+      // Дерево строится до этой границы и обрезается по своим уровням
+      estimate.vertices_count_bound =
+          std::min(std::ceil(ATTACHMENT_VERTICES_HEADROOM * vertices_count),
+                   double(MAX_ATTACHMENT_VERTICES_COUNT));
+    }
+    estimate.edges_count =
+        attachment_edges_per_vertex_ * estimate.vertices_count;
+    double colored_probabilities_sum = 0;
+    for (const auto& color : {Edge::Color::Green, Edge::Color::Blue,
+                              Edge::Color::Yellow, Edge::Color::Red}) {
+      colored_probabilities_sum += policy_.get_color_probability(color);
+    }
+    // Каждая вершина начинает не больше одного ребра каждого цвета
+    // с вероятностью не больше вероятности цвета
+    const double colored_edges_count =
+        colored_probabilities_sum * estimate.vertices_count;
+    // С целью по ребрам дерево обрезается, как только ожидаемое число
+    // ребер дошло до цели, и отклоняются от нее только цветные ребра
+    estimate.edges_count_bound =
+        (is_edges_target ? params_.size_target->count
+                         : estimate.vertices_count - 1 + colored_edges_count) +
+        ESTIMATE_BOUND_DEVIATIONS * std::sqrt(colored_edges_count);
+  }
+  estimate.bytes_bound = estimate.vertices_count_bound * VERTEX_BYTES +
+                         estimate.edges_count_bound * EDGE_BYTES;
+  // В дереве ребер на одно меньше, чем вершин
+  estimate.skeleton_bytes_bound =
+      estimate.vertices_count_bound * (VERTEX_BYTES + EDGE_BYTES);
+  estimate.overlay_bytes_bound =
+      std::max(0.0, estimate.edges_count_bound -
+                        estimate.vertices_count_bound) *
+      sizeof(GraphVariant::EdgeList::value_type);
+  return estimate;
+}
+
+template <typename Policy>
+int BasicGraphGenerator<Policy>::count_gray_children(
+    VertexIdSpan parent_ids,
+    const Depth& parent_depth,
+    const std::vector<int>& layer_sizes,
+    int graph_index,
+    std::vector<int>& children_counts) const {
+  const int vertices_budget = get_vertices_budget(parent_depth, layer_sizes);
+  const auto distribution = get_layer_children_distribution(
+      parent_depth, parent_ids.size(), vertices_budget);
+  children_counts.resize(parent_ids.size());
+  for (int idx = 0; idx < parent_ids.size(); ++idx) {
+    auto random_source =
+        RandomSource(seed_, {graph_index, parent_ids[idx], Edge::Color::Gray});
+    children_counts[idx] = random_source.get_binomial(distribution);
+  }
+  return truncate_children_counts(children_counts, vertices_budget);
+}
+
+template <typename Policy>
+GraphStats BasicGraphGenerator<Policy>::generate_stats(int graph_index) const {
+  auto stats = GraphStats();
+  stats.vertices_at_depth.push_back(1);
+  std::vector<VertexId> vertex_ids;
+  std::vector<int> children_counts;
+  // Первый проход - размеры уровней: от глубины графа зависят
+  // вероятности желтых и красных ребер. Id уровня идут подряд.
+  if (params_.depth > 0 && get_new_vertices_num() > 0) {
+    VertexId first_vertex_id = 0;
+    for (Depth depth = 0; depth < params_.depth; ++depth) {
+      const int layer_size = stats.vertices_at_depth.back();
+      vertex_ids.resize(layer_size);
+      std::iota(vertex_ids.begin(), vertex_ids.end(), first_vertex_id);
+      const int children_total =
+          count_gray_children(vertex_ids, depth, stats.vertices_at_depth,
+                              graph_index, children_counts);
+      if (children_total == 0) {
+        break;
+      }
+      stats.vertices_at_depth.push_back(children_total);
+      first_vertex_id += layer_size;
+    }
+  }
+  stats.depth = stats.vertices_at_depth.size() - 1;
+
+  const auto get_layer_size = [&stats](const Depth& depth) {
+    return depth <= stats.depth ? stats.vertices_at_depth[depth] : 0;
+  };
+  auto& edges_of_color = stats.edges_of_color;
+  edges_of_color[Edge::Color::Gray] = stats.count_vertices() - 1;
+  VertexId first_vertex_id = 0;
+  for (Depth depth = 0; depth <= stats.depth; ++depth) {
+    const int layer_size = get_layer_size(depth);
+    if (policy_.is_color_enabled(Edge::Color::Green)) {
+      edges_of_color[Edge::Color::Green] += count_green_edges(
+          policy_.get_color_probability(Edge::Color::Green), seed_,
+          graph_index, depth, layer_size);
+    }
+    if (policy_.is_color_enabled(Edge::Color::Blue)) {
+      edges_of_color[Edge::Color::Blue] += count_blue_edges(
+          policy_.get_color_probability(Edge::Color::Blue), seed_, graph_index,
+          depth, layer_size);
+    }
+    if (policy_.is_color_enabled(Edge::Color::Red)) {
+      edges_of_color[Edge::Color::Red] += count_red_edges(
+          policy_.get_color_probability(Edge::Color::Red), seed_, graph_index,
+          depth, stats.depth, layer_size, get_layer_size(depth + 2));
+    }
+    // Для желтых ребер нужно число детей каждой вершины, оно
+    // разыгрывается повторно, чтобы не хранить его для всего графа
+    if (policy_.is_color_enabled(Edge::Color::Yellow) && depth > 0 &&
+        depth < stats.depth) {
+      vertex_ids.resize(layer_size);
+      std::iota(vertex_ids.begin(), vertex_ids.end(), first_vertex_id);
+      count_gray_children(vertex_ids, depth, stats.vertices_at_depth,
+                          graph_index, children_counts);
+      edges_of_color[Edge::Color::Yellow] += count_yellow_edges(
+          policy_.get_color_probability(Edge::Color::Yellow), seed_,
+          graph_index, depth, stats.depth, vertex_ids, children_counts,
+          get_layer_size(depth + 1));
+    }
+    first_vertex_id += layer_size;
+  }
+  return stats;
+}
+
+template <typename Policy>
+Depth BasicGraphGenerator<Policy>::get_gray_depth(int graph_index) const {
+  if (params_.depth <= 0 || get_new_vertices_num() <= 0) {
+    return 0;
+  }
+  // Id уровня идут подряд, поэтому хватает размеров уровней
+  std::vector<VertexId> parent_ids = {0};
+  std::pmr::vector<VertexId> child_parent_ids;
+  std::vector<int> layer_sizes = {1};
+  VertexId first_child_id = 1;
+  Depth depth = 0;
+  while (depth < params_.depth) {
+    generate_next_gray_layer(parent_ids, depth, layer_sizes, graph_index,
+                             child_parent_ids);
+    if (child_parent_ids.empty()) {
+      break;
+    }
+    layer_sizes.push_back(child_parent_ids.size());
+    parent_ids.resize(child_parent_ids.size());
+    std::iota(parent_ids.begin(), parent_ids.end(), first_child_id);
+    first_child_id += parent_ids.size();
+    ++depth;
+  }
+  return depth;
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::generate_to_file(
+    const std::string& file_path,
+    int graph_index) const {
+  // Вероятности желтых и красных ребер зависят от глубины всего графа,
+  // поэтому сначала она находится проходом, считающим только размеры
+  const Depth graph_depth = get_gray_depth(graph_index);
+  auto writer = GraphFileWriter(file_path, graph_depth);
+
+  // Окно из уровней [depth, depth + 2]: цветные ребра из уровня depth
+  // не идут дальше depth + 2, поэтому уровень записывается и удаляется
+  // сразу после своих цветных проходов
+  std::deque<StreamLayer> window(1);
+  window.front().vertex_ids.push_back(0);
+  window.front().parent_ids.push_back(NO_PARENT);
+  window.front().vertices.emplace_back(0);
+  // Размеры уже построенных уровней, нужны бюджету size_target
+  std::vector<int> layer_sizes = {1};
+  VertexId next_vertex_id = 1;
+  EdgeId next_edge_id = 0;
+  const auto add_edge = [&window, &writer, &next_edge_id](
+                            const VertexId& from_vertex_id,
+                            const VertexId& to_vertex_id,
+                            const Edge::Color& color) {
+    const auto edge = Edge(from_vertex_id, to_vertex_id, next_edge_id++, color);
+    get_stream_vertex(window, from_vertex_id)
+        .add_neighbor(to_vertex_id, edge.get_id(), color);
+    if (from_vertex_id != to_vertex_id) {
+      get_stream_vertex(window, to_vertex_id)
+          .add_neighbor(from_vertex_id, edge.get_id(), color);
+    }
+    writer.write_edge(edge);
+  };
+
+  for (Depth depth = 0; depth <= graph_depth; ++depth) {
+    // Достраиваем серые уровни до depth + 2 так же, как generate_gray_layers
+    while (depth + Depth(window.size()) <= std::min(depth + 2, graph_depth)) {
+      const Depth parent_depth = depth + window.size() - 1;
+      auto layer = StreamLayer();
+      generate_next_gray_layer(window.back().vertex_ids, parent_depth,
+                               layer_sizes, graph_index, layer.parent_ids);
+      layer_sizes.push_back(layer.parent_ids.size());
+      layer.vertex_ids.resize(layer.parent_ids.size());
+      std::iota(layer.vertex_ids.begin(), layer.vertex_ids.end(),
+                next_vertex_id);
+      next_vertex_id += layer.vertex_ids.size();
+      layer.vertices.reserve(layer.vertex_ids.size());
+      for (const auto& vertex_id : layer.vertex_ids) {
+        layer.vertices.emplace_back(vertex_id).depth = parent_depth + 1;
+      }
+      window.push_back(std::move(layer));
+      const auto& child_layer = window.back();
+      for (int idx = 0; idx < int(child_layer.vertex_ids.size()); ++idx) {
+        add_edge(child_layer.parent_ids[idx], child_layer.vertex_ids[idx],
+                 Edge::Color::Gray);
+      }
+    }
+
+    // Дети вершины на следующем уровне идут подряд: родители в parent_ids
+    // расположены по возрастанию
+    const auto get_child_positions = [&window](
+                                         const VertexId& vertex_id,
+                                         std::pmr::vector<int>& positions) {
+      const auto& parent_ids = window[1].parent_ids;
+      const auto [first, last] =
+          std::equal_range(parent_ids.begin(), parent_ids.end(), vertex_id);
+      positions.resize(last - first);
+      std::iota(positions.begin(), positions.end(), first - parent_ids.begin());
+    };
+    const auto layers = ColorPassLayers{
+        graph_depth, depth, window[0].vertex_ids,
+        window.size() > 1 ? window[1].vertex_ids : VertexIdSpan(),
+        window.size() > 2 ? window[2].vertex_ids : VertexIdSpan()};
+    auto layer_edges = LayerEdges();
+    generate_layer_edges_fused(layers, policy_, get_child_positions, seed_,
+                               graph_index, layer_edges);
+    for (const auto& [edges, color] :
+         {std::pair{&layer_edges.green, Edge::Color::Green},
+          std::pair{&layer_edges.yellow, Edge::Color::Yellow},
+          std::pair{&layer_edges.red, Edge::Color::Red},
+          std::pair{&layer_edges.blue, Edge::Color::Blue}}) {
+      for (const auto& [from_vertex_id, to_vertex_id] : *edges) {
+        add_edge(from_vertex_id, to_vertex_id, color);
+      }
+    }
+
+    for (const auto& vertex : window.front().vertices) {
+      writer.write_vertex(vertex);
+    }
+    window.pop_front();
+  }
+  writer.finish();
+}
+
+template <typename Policy>
+Graph BasicGraphGenerator<Policy>::generate_gray_tree(
+    int graph_index,
+    bool reserve_colored_edges,
+    std::pmr::memory_resource* memory_resource) const {
+  auto graph = Graph(memory_resource);
+  // Место выделяется по оценке сверху: хеш-таблицы почти никогда
+  // не перестраиваются, а лишние корзины - это только указатели
+  const auto estimate = estimate_size();
+  const auto to_reserve_count = [](double count) {
+    return int(std::min(count, double(std::numeric_limits<int>::max())));
+  };
+  graph.reserve(to_reserve_count(estimate.vertices_count_bound),
+                to_reserve_count(reserve_colored_edges
+                                     ? estimate.edges_count_bound
+                                     : estimate.vertices_count_bound),
+                params_.depth);
+  graph.set_validation_mode(params_.validation_mode);
+  const VertexId& new_vertex_id = graph.add_vertex();
+  if (params_.gray_mode == GrayMode::PreferentialAttachment) {
+    generate_attachment_tree(graph, graph_index,
+                             estimate.vertices_count_bound);
+  } else if (params_.depth > 0 && get_new_vertices_num() > 0) {
+    if (params_.gray_mode == GrayMode::Layers) {
+      generate_gray_layers(graph, graph_index);
+    } else {
+      generate_gray_edges(graph, graph_index, new_vertex_id);
+    }
+  }
+  return graph;
+}
+
+template <typename Policy>
+Graph BasicGraphGenerator<Policy>::generate(
+    int graph_index,
+    std::pmr::memory_resource* memory_resource) const {
+  auto graph = generate_gray_tree(graph_index, true, memory_resource);
+  add_colored_edges(
+      graph, [this](const Depth&) { return policy_; }, params_.color_kernel,
+      seed_, graph_index);
+  if (params_.validation_mode == ValidationMode::Full) {
+    validate(graph);
+  }
+  return graph;
+}
+
+template <typename Policy>
+std::shared_ptr<const Graph> BasicGraphGenerator<Policy>::generate_skeleton(
+    int graph_index) const {
+  auto skeleton = generate_gray_tree(graph_index, false,
+                                     std::pmr::get_default_resource());
+  if (params_.validation_mode == ValidationMode::Full) {
+    validate(skeleton);
+  }
+  return std::make_shared<const Graph>(std::move(skeleton));
+}
+
+template <typename Policy>
+GraphVariant BasicGraphGenerator<Policy>::generate_variant(
+    const std::shared_ptr<const Graph>& skeleton,
+    int variant_index) const {
+  // Варианты лежат в ресурсе по умолчанию, он потокобезопасен
+  const auto layers_edges = generate_colored_edges(
+      *skeleton, [this](const Depth&) { return policy_; },
+      params_.color_kernel, seed_, variant_index, 0,
+      get_colored_edges_threads_count(*skeleton, 0),
+      std::pmr::get_default_resource());
+  auto variant = GraphVariant(skeleton);
+  for_each_colored_edge_list(
+      layers_edges,
+      [&variant](const EdgeList& edges, const Edge::Color& color) {
+        variant.add_edges(edges, color);
+      });
+  if (params_.validation_mode == ValidationMode::Full) {
+    validate(variant.to_graph());
+  }
+  return variant;
+}
+
+template <typename Policy>
+GraphBatch BasicGraphGenerator<Policy>::generate_batch(int first_graph_index,
+                                                       int graphs_count) const {
+  if (params_.gray_mode != GrayMode::Layers) {
+    throw std::invalid_argument(
+        "generate_batch builds gray trees by layers only");
+  }
+  auto batch = GraphBatch();
+  batch.first_graph_index = first_graph_index;
+  batch.validation_mode = params_.validation_mode;
+  const auto estimate = estimate_size();
+  batch.vertices_offsets.reserve(graphs_count + 1);
+  batch.edges_offsets.reserve(graphs_count + 1);
+  batch.vertex_depths.reserve(graphs_count * estimate.vertices_count);
+  batch.edge_from_vertex_ids.reserve(graphs_count * estimate.edges_count);
+  batch.edge_to_vertex_ids.reserve(graphs_count * estimate.edges_count);
+  batch.edge_colors.reserve(graphs_count * estimate.edges_count);
+
+  auto lanes = std::vector<BatchLane>(BATCH_LANES);
+  std::pmr::vector<LayerEdges> layers_edges;
+  for (int first_lane_idx = 0; first_lane_idx < graphs_count;
+       first_lane_idx += BATCH_LANES) {
+    const int lanes_count =
+        std::min(BATCH_LANES, graphs_count - first_lane_idx);
+    for (int lane_idx = 0; lane_idx < lanes_count; ++lane_idx) {
+      lanes[lane_idx].graph_index =
+          first_graph_index + first_lane_idx + lane_idx;
+    }
+    generate_batch_gray_layers(lanes, lanes_count);
+
+    for (int lane_idx = 0; lane_idx < lanes_count; ++lane_idx) {
+      const auto& lane = lanes[lane_idx];
+      const auto get_vertices_at_depth = [&lane](const Depth& depth) {
+        return depth <= lane.depth ? VertexIdSpan(lane.layers[depth])
+                                   : VertexIdSpan();
+      };
+      // Буферы ребер остаются от прошлого графа вместе с памятью
+      layers_edges.resize(lane.depth + 1);
+      for (auto& layer_edges : layers_edges) {
+        layer_edges.green.clear();
+        layer_edges.yellow.clear();
+        layer_edges.red.clear();
+        layer_edges.blue.clear();
+      }
+      for (Depth depth = 0; depth <= lane.depth; ++depth) {
+        const auto layers = ColorPassLayers{
+            lane.depth, depth, get_vertices_at_depth(depth),
+            get_vertices_at_depth(depth + 1), get_vertices_at_depth(depth + 2)};
+        // Дети вершины идут подряд с начала своего куска уровня
+        const auto get_child_positions = [&lane, &layers](
+                                             const VertexId& vertex_id,
+                                             std::pmr::vector<int>& positions) {
+          positions.clear();
+          for (VertexId child_id = lane.first_child_ids[vertex_id];
+               child_id < lane.first_child_ids[vertex_id + 1]; ++child_id) {
+            positions.push_back(child_id -
+                                layers.vertices_at_next_depth.front());
+          }
+        };
+        generate_layer_edges_fused(layers, policy_, get_child_positions, seed_,
+                                   lane.graph_index, layers_edges[depth]);
+      }
+
+      for (Depth depth = 0; depth <= lane.depth; ++depth) {
+        batch.vertex_depths.insert(batch.vertex_depths.end(),
+                                   lane.layers[depth].size(), depth);
+      }
+      const auto add_edge = [&batch](const VertexId& from_vertex_id,
+                                     const VertexId& to_vertex_id,
+                                     const Edge::Color& color) {
+        batch.edge_from_vertex_ids.push_back(from_vertex_id);
+        batch.edge_to_vertex_ids.push_back(to_vertex_id);
+        batch.edge_colors.push_back(color);
+      };
+      for (VertexId vertex_id = 1; vertex_id < int(lane.parent_ids.size());
+           ++vertex_id) {
+        add_edge(lane.parent_ids[vertex_id], vertex_id, Edge::Color::Gray);
+      }
+      for_each_colored_edge_list(
+          layers_edges,
+          [&add_edge](const EdgeList& edges, const Edge::Color& color) {
+            for (const auto& [from_vertex_id, to_vertex_id] : edges) {
+              add_edge(from_vertex_id, to_vertex_id, color);
+            }
+          });
+      batch.vertices_offsets.push_back(batch.vertex_depths.size());
+      batch.edges_offsets.push_back(batch.edge_colors.size());
+    }
+  }
+
+  if (params_.validation_mode == ValidationMode::Full) {
+    for (int idx = 0; idx < batch.count_graphs(); ++idx) {
+      validate(batch.get_graph(idx));
+    }
+  }
+  return batch;
+}
+
+template <typename Policy>
+void BasicGraphGenerator<Policy>::extend(Graph& graph,
+                                         const Depth& new_depth,
+                                         int graph_index) const {
+  if (params_.gray_mode != GrayMode::Layers || params_.size_target) {
+    throw std::invalid_argument(
+        "extend supports Layers mode without size_target only");
+  }
+  const Depth old_depth = graph.get_depth();
+  if (new_depth <= old_depth || get_new_vertices_num() == 0) {
+    return;
+  }
+  // Серые уровни достраиваются от самого глубокого так же, как
+  // в generate_gray_layers, но по расписанию графа глубины new_depth
+  std::pmr::vector<VertexId> child_parent_ids(graph.get_memory_resource());
+  for (Depth current_depth = old_depth; current_depth < new_depth;
+       ++current_depth) {
+    generate_gray_layer(
+        graph.get_vertices_at_depth(current_depth),
+        get_children_count_distribution(current_depth, new_depth),
+        graph_index, child_parent_ids);
+    if (child_parent_ids.empty()) {
+      break;
+    }
+    graph.add_layer(child_parent_ids);
+  }
+  if (graph.get_depth() == old_depth) {
+    return;
+  }
+
+  // Ребра уровней до old_depth - 2 не зависят от новых уровней и остаются.
+  // Уровню old_depth - 1 добавляются только красные ребра, уровню
+  // old_depth - желтые и красные: раньше их концов не было. Зеленые и синие
+  // ребра этих уровней и желтые ребра old_depth - 1 уже есть в графе,
+  // а их потоки случайных чисел ключуются уровнем, поэтому они те же.
+  add_colored_edges(
+      graph,
+      [this, old_depth](const Depth& depth) {
+        auto layer_policy = ColorMaskPolicy<Policy>{policy_};
+        layer_policy.is_enabled.fill(depth > old_depth);
+        layer_policy.is_enabled[int(Edge::Color::Red)] = true;
+        layer_policy.is_enabled[int(Edge::Color::Yellow)] =
+            depth >= old_depth;
+        return layer_policy;
+      },
+      params_.color_kernel, seed_, graph_index, std::max(0, old_depth - 1));
+  if (graph.get_validation_mode() == ValidationMode::Full) {
+    validate(graph);
+  }
+}
+
+template class BasicGraphGenerator<DefaultPolicy>;
+template class BasicGraphGenerator<RuntimePolicy>;
+}  // namespace uni_cpp_practice
@@ -1,31 +1,367 @@
-#pragma once
-
-#include <mutex>
-#include "graph.hpp"
-
-namespace uni_cpp_practice {
-
-class GraphGenerator {
- public:
-  struct Params {
-    explicit Params(Depth _depth = 0, int _new_vertices_num = 0)
-        : depth(_depth), new_vertices_num(_new_vertices_num) {}
-
-    const Depth depth = 0;
-    const int new_vertices_num = 0;
-  };
-
-  explicit GraphGenerator(const Params& params = Params()) : params_(params) {}
-
-  Graph generate() const;
-
- private:
-  const Params params_ = Params();
-  void generate_gray_edges(Graph& graph,
-                           const VertexId& parent_vertex_id) const;
-  void generate_gray_branch(Graph& graph,
-                            std::mutex& mutex_add,
-                            const VertexId& parent_vertex_id,
-                            const Depth current_depth) const;
-};
-}  // namespace uni_cpp_practice
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "generation_policy.hpp"
+#include "graph.hpp"
+#include "graph_variant.hpp"
+#include "random_source.hpp"
+
+namespace uni_cpp_practice {
+
+// Размеры графа без самого графа: глубина, число вершин на каждой
+// глубине и число ребер каждого цвета
+struct GraphStats {
+  Depth depth = 0;
+  std::vector<int> vertices_at_depth;
+  std::unordered_map<Edge::Color, int> edges_of_color;
+
+  int count_vertices() const;
+  int count_edges() const;
+  int count_edges_of_color(const Edge::Color& color) const;
+};
+
+// Оценка размера графа по параметрам генератора, без генерации
+struct GraphSizeEstimate {
+  // Математические ожидания
+  double vertices_count = 0;
+  double edges_count = 0;
+  // Среднее плюс три стандартных отклонения, но не больше возможного
+  // максимума: граф больше этого получается редко
+  double vertices_count_bound = 0;
+  double edges_count_bound = 0;
+  // Сколько памяти займет граф с vertices_count_bound вершинами
+  // и edges_count_bound ребрами, в байтах
+  double bytes_bound = 0;
+  // То же для серого дерева и для цветных ребер одного GraphVariant
+  double skeleton_bytes_bound = 0;
+  double overlay_bytes_bound = 0;
+};
+
+// Сколько графов generate_batch строит в ногу
+constexpr int BATCH_LANES = 16;
+
+// Предел числа вершин режима PreferentialAttachment: в списке концов
+// ребер дерева 2 * vertices_count - 1 элементов, и их номера - int
+constexpr int MAX_ATTACHMENT_VERTICES_COUNT =
+    std::numeric_limits<int>::max() / 2;
+
+// Графы generate_batch в виде структуры массивов: данные всех графов лежат
+// подряд в общих массивах, объекты Graph не создаются. Вершины i-го графа
+// пакета - [vertices_offsets[i], vertices_offsets[i + 1]) в vertex_depths,
+// его ребра - [edges_offsets[i], edges_offsets[i + 1]) в массивах ребер.
+// Id вершин - номера внутри графа в порядке обхода в ширину, ребра идут
+// в порядке их номеров в generate: сначала серые, по одному на каждую
+// вершину, кроме корня, затем зеленые, желтые, красные и синие.
+struct GraphBatch {
+  int first_graph_index = 0;
+  ValidationMode validation_mode = ValidationMode::Cheap;
+  std::vector<int> vertices_offsets = {0};
+  std::vector<int> edges_offsets = {0};
+  std::vector<Depth> vertex_depths;
+  std::vector<VertexId> edge_from_vertex_ids;
+  std::vector<VertexId> edge_to_vertex_ids;
+  std::vector<Edge::Color> edge_colors;
+
+  int count_graphs() const { return int(vertices_offsets.size()) - 1; }
+  // Граф generate(first_graph_index + idx) с теми же id вершин и ребер
+  // в memory_resource
+  Graph get_graph(int idx,
+                  std::pmr::memory_resource* memory_resource =
+                      std::pmr::get_default_resource()) const;
+};
+
+// Типы, общие для генераторов со всеми политиками
+class GraphGeneratorBase {
+ public:
+  // Способ построения серого дерева:
+  // Layers - в ширину, каждый уровень делится между всеми потоками,
+  // id вершин идут в порядке обхода в ширину;
+  // Branches - ветви нулевой вершины строятся параллельно в глубину;
+  // PreferentialAttachment - безмасштабное дерево: вершины по одной
+  // присоединяются к уже созданным с вероятностью, пропорциональной
+  // степени. Размер задается size_target, без него вершин столько,
+  // сколько в среднем дает дерево с теми же depth и new_vertices_num.
+  // Глубина ограничена только числом вершин, id вершин идут в порядке
+  // обхода в ширину. Для графов больше MAX_ATTACHMENT_VERTICES_COUNT
+  // вершин или больше INT_MAX ребер конструктор генератора бросает
+  // std::invalid_argument. Такой граф занимает около 100 байт на ребро
+  // (вершина - 64 байта, ребро - 16, индекс пар - 24, соседи вершин
+  // с большой степенью - остальное), так что на 100 млн ребер нужно
+  // около 10 ГБ памяти.
+  enum class GrayMode { Layers, Branches, PreferentialAttachment };
+
+  // Способ построения цветных ребер уровня:
+  // Fused - один проход по вершинам уровня сразу для всех цветов;
+  // Passes - отдельный проход на каждый цвет, оставлен для сравнения.
+  // Графы получаются одинаковые.
+  enum class ColorKernel { Fused, Passes };
+
+  // Целевой размер графа: число вершин или ребер
+  struct SizeTarget {
+    enum class Kind { Vertices, Edges };
+
+    Kind kind = Kind::Vertices;
+    int count = 0;
+  };
+
+  struct Params {
+    explicit Params(Depth _depth = 0,
+                    int _new_vertices_num = 0,
+                    std::optional<RandomSource::Seed> _seed = std::nullopt,
+                    GrayMode _gray_mode = GrayMode::Layers,
+                    ValidationMode _validation_mode = ValidationMode::Cheap,
+                    ColorKernel _color_kernel = ColorKernel::Fused,
+                    std::optional<SizeTarget> _size_target = std::nullopt)
+        : depth(_depth),
+          new_vertices_num(_new_vertices_num),
+          seed(_seed),
+          gray_mode(_gray_mode),
+          validation_mode(_validation_mode),
+          color_kernel(_color_kernel),
+          size_target(_size_target) {}
+
+    const Depth depth = 0;
+    const int new_vertices_num = 0;
+    // С одним и тем же seed генератор выдает одни и те же графы.
+    // Если seed не задан, он выбирается случайно при создании генератора.
+    const std::optional<RandomSource::Seed> seed = std::nullopt;
+    const GrayMode gray_mode = GrayMode::Layers;
+    // Режим проверок графов, которые строит generate
+    const ValidationMode validation_mode = ValidationMode::Cheap;
+    const ColorKernel color_kernel = ColorKernel::Fused;
+    // Если задан, генератор сам подбирает new_vertices_num (не меньше
+    // заданного) и множитель вероятностей серого расписания так, чтобы
+    // граф глубины depth получился нужного размера. После каждого уровня
+    // расписание оставшихся уровней пересчитывается по фактическому числу
+    // вершин, а дети сверх бюджета вершин отбрасываются с конца уровня:
+    // обычно вершин получается ровно count. Меньше - только если даже
+    // удвоенные вероятности не добирают бюджет к глубине depth, так
+    // бывает на небольших графах (до пары процентов от count).
+    // С целью по ребрам бюджет вершин после каждого уровня решается
+    // заново так, чтобы ожидаемое по фактическим уровням число ребер
+    // совпало с целью. Остается разброс цветных ребер: в тестах до 0,5%
+    // на 50 тыс. ребер и до 0,15% на 1 млн. У глубоких деревьев (depth
+    // от 20) на 50 тыс. ребер - до 2,5%: хвост вымирает раньше depth, как
+    // и при недоборе вершин. Если у корня не выпало детей, граф остается
+    // из одной вершины при любой цели.
+    // В режиме PreferentialAttachment цель по вершинам задает число вершин
+    // дерева напрямую, а с целью по ребрам дерево растет, пока ожидаемое
+    // по размерам его уровней число ребер не дойдет до цели; depth
+    // и new_vertices_num не используются.
+    // В режиме Branches не поддерживается: конструктор генератора бросает
+    // std::invalid_argument.
+    const std::optional<SizeTarget> size_target = std::nullopt;
+  };
+};
+
+// Генератор графов с политикой Policy (см. generation_policy.hpp).
+// Реализация лежит в graph_generator.cpp и явно инстанцирована для
+// DefaultPolicy и RuntimePolicy, новую политику нужно добавить туда же.
+template <typename Policy>
+class BasicGraphGenerator : public GraphGeneratorBase {
+ public:
+  explicit BasicGraphGenerator(const Params& params = Params(),
+                               const Policy& policy = Policy());
+
+  // graph_index - номер графа в пакете: граф определяется только
+  // парой (seed, graph_index) и не зависит от числа потоков.
+  // Граф создается в memory_resource (см. BasicGraph).
+  Graph generate(int graph_index = 0,
+                 std::pmr::memory_resource* memory_resource =
+                     std::pmr::get_default_resource()) const;
+
+  // Достраивает граф, построенный generate(graph_index) в режиме Layers,
+  // до глубины new_depth, не перестраивая его. Новые серые уровни
+  // разыгрываются по расписанию 1 - d / new_depth, цветные ребра
+  // добавляются только уровням от old_depth - 1, где появились новые
+  // концы. Уже построенные ребра не меняются, поэтому вероятности желтых
+  // ребер старых уровней остаются посчитанными по старой глубине.
+  // Для других GrayMode и с size_target бросает std::invalid_argument.
+  void extend(Graph& graph, const Depth& new_depth, int graph_index = 0) const;
+
+  // Серое дерево графа generate(graph_index) без цветных ребер, его можно
+  // разделить между вариантами и потоками
+  std::shared_ptr<const Graph> generate_skeleton(int graph_index = 0) const;
+
+  // Цветные ребра поверх skeleton, разыгранные так же, как в
+  // generate(variant_index): вариант с variant_index, равным номеру
+  // дерева, совпадает с generate по вершинам и ребрам
+  GraphVariant generate_variant(const std::shared_ptr<const Graph>& skeleton,
+                                int variant_index) const;
+
+  // Строит тот же граф, что и generate в режиме Layers, но пишет его
+  // в файл file_path (формат GraphPrinter) по уровням, не держа в памяти
+  // больше трех уровней сразу. Серое дерево всегда строится в ширину.
+  // Вершины и ребра совпадают с generate, номера ребер - нет:
+  // ребра нумеруются в порядке записи.
+  void generate_to_file(const std::string& file_path,
+                        int graph_index = 0) const;
+
+  // Считает размеры графа, который generate строит в режиме Layers,
+  // разыгрывая те же случайные числа, но не создавая вершин и ребер.
+  // Память - порядка одного уровня, время - без построения связей.
+  GraphStats generate_stats(int graph_index = 0) const;
+
+  // Размер графа по params, считается аналитически один раз при создании
+  // генератора: размеры уровней - ветвящийся процесс с
+  // Binomial(new_vertices_num, 1 - d / depth) детьми. В режиме
+  // PreferentialAttachment число вершин известно точно, ребер в среднем
+  // столько, сколько у пробного дерева, а сверху ребра оцениваются
+  // одним ребром каждого цвета на вершину.
+  GraphSizeEstimate estimate_size() const { return size_estimate_; }
+
+  // Графы generate(first_graph_index), ..., generate(first_graph_index +
+  // graphs_count - 1) разом, для маленьких графов. Серые уровни графов
+  // строятся в ногу по BATCH_LANES: первые числа потоков всех вершин
+  // уровня этих графов считаются вместе, по 8 на AVX2, а цветные ребра -
+  // тем же проходом, что и в generate, но без потоков и хеш-таблиц.
+  // Только режим Layers, в остальных бросает std::invalid_argument.
+  GraphBatch generate_batch(int first_graph_index, int graphs_count) const;
+
+  const RandomSource::Seed& get_seed() const { return seed_; }
+
+ private:
+  // Ветвь серого дерева, построенная отдельно от графа. Дети одной вершины
+  // создаются разом и получают подряд идущие локальные номера,
+  // children[i] - (локальный номер родителя, число его детей) в порядке
+  // создания групп.
+  struct GrayBranch {
+    int vertices_count = 0;
+    std::vector<std::pair<int, int>> children;
+  };
+
+  // Граф пакета generate_batch, пока он строится. Id уровня идут подряд,
+  // layers[0..depth] - уровни графа, дети вершины v - id
+  // [first_child_ids[v], first_child_ids[v + 1]). Буферы переиспользуются
+  // от графа к графу.
+  struct BatchLane {
+    int graph_index = 0;
+    Depth depth = 0;
+    std::vector<std::vector<VertexId>> layers;
+    std::vector<VertexId> parent_ids;
+    std::vector<VertexId> first_child_ids;
+  };
+
+  // Подобранные под Params::size_target размер и расписание
+  struct TargetPlan {
+    int vertices_count = 0;
+    int new_vertices_num = 0;
+    // Множитель вероятностей серого расписания для всего дерева
+    double probability_scale = 1;
+  };
+
+  const Params params_ = Params();
+  const Policy policy_ = Policy();
+  const RandomSource::Seed seed_ = 0;
+  // Среднее число ребер на вершину в режиме PreferentialAttachment
+  const double attachment_edges_per_vertex_ = 0;
+  const std::optional<TargetPlan> target_plan_ = std::nullopt;
+  const GraphSizeEstimate size_estimate_ = GraphSizeEstimate();
+
+  std::optional<TargetPlan> make_target_plan() const;
+  GraphSizeEstimate make_size_estimate() const;
+  int get_new_vertices_num() const {
+    return target_plan_ ? target_plan_->new_vertices_num
+                        : params_.new_vertices_num;
+  }
+  // План для vertices_count вершин
+  TargetPlan make_vertices_target_plan(double vertices_count) const;
+
+  // Граф из одной серой части в memory_resource, место под цветные ребра
+  // выделяется при reserve_colored_edges
+  Graph generate_gray_tree(int graph_index,
+                           bool reserve_colored_edges,
+                           std::pmr::memory_resource* memory_resource) const;
+
+  // Распределение числа детей вершины на глубине depth
+  BinomialDistribution get_children_count_distribution(
+      const Depth& depth) const;
+  // То же для графа глубины max_depth
+  BinomialDistribution get_children_count_distribution(
+      const Depth& depth,
+      const Depth& max_depth) const;
+
+  // Распределение числа детей вершин уровня parent_depth из
+  // parents_count вершин, когда в граф можно добавить еще vertices_budget
+  // вершин. Без size_target - то же, что get_children_count_distribution.
+  BinomialDistribution get_layer_children_distribution(
+      const Depth& parent_depth,
+      int parents_count,
+      int vertices_budget) const;
+  // Сколько еще вершин можно добавить в граф, у которого уровни
+  // 0..parent_depth имеют размеры layer_sizes (дальше layer_sizes
+  // не читается). С целью по ребрам бюджет каждый раз решается заново:
+  // ожидаемое по фактическим уровням и расписанию оставшихся число ребер
+  // должно совпасть с целью.
+  int get_vertices_budget(const Depth& parent_depth,
+                          const std::vector<int>& layer_sizes) const;
+  // Ожидаемое число ребер графа, у которого уровни 0..parent_depth имеют
+  // размеры layer_sizes, а оставшиеся уровни разыграны с множителем
+  // вероятностей probability_scale и обрезаны по vertices_budget вершин
+  double get_target_edges_mean(const Depth& parent_depth,
+                               const std::vector<int>& layer_sizes,
+                               double probability_scale,
+                               double vertices_budget) const;
+
+  // Разыгрывает детей уровня parent_ids: child_parent_ids[i] - родитель
+  // i-го ребенка следующего уровня в порядке обхода в ширину. Временные
+  // буферы берут память из ресурса child_parent_ids.
+  void generate_gray_layer(VertexIdSpan parent_ids,
+                           const BinomialDistribution& distribution,
+                           int graph_index,
+                           std::pmr::vector<VertexId>& child_parent_ids) const;
+  // Следующий уровень графа с размерами уровней layer_sizes (как
+  // в get_vertices_budget) с учетом size_target: дети сверх бюджета
+  // отбрасываются
+  void generate_next_gray_layer(
+      VertexIdSpan parent_ids,
+      const Depth& parent_depth,
+      const std::vector<int>& layer_sizes,
+      int graph_index,
+      std::pmr::vector<VertexId>& child_parent_ids) const;
+  void generate_gray_layers(Graph& graph, int graph_index) const;
+  // Серые деревья графов lanes[0..lanes_count) в ногу, уровень за уровнем
+  void generate_batch_gray_layers(std::vector<BatchLane>& lanes,
+                                  int lanes_count) const;
+  // Разыгрывает число детей каждой вершины parent_ids в одном потоке
+  // так же, как generate_next_gray_layer, возвращает их сумму
+  int count_gray_children(VertexIdSpan parent_ids,
+                          const Depth& parent_depth,
+                          const std::vector<int>& layer_sizes,
+                          int graph_index,
+                          std::vector<int>& children_counts) const;
+  // Глубина серого дерева без построения самого дерева
+  Depth get_gray_depth(int graph_index) const;
+  void generate_gray_edges(Graph& graph,
+                           int graph_index,
+                           const VertexId& parent_vertex_id) const;
+  // Оценка attachment_edges_per_vertex_ по пробному дереву, общему
+  // для всех генераторов
+  double get_attachment_edges_per_vertex() const;
+  // Наименьшее число первых вершин дерева с родителями parent_ids,
+  // при котором ожидаемое число ребер графа не меньше edges_count
+  // (или все вершины, если их не хватает)
+  int get_attachment_vertices_count(const std::vector<VertexId>& parent_ids,
+                                    double edges_count) const;
+  // Дерево режима PreferentialAttachment из max_vertices_count вершин,
+  // с целью по ребрам - из стольких первых, сколько нужно для цели
+  void generate_attachment_tree(Graph& graph,
+                                int graph_index,
+                                int max_vertices_count) const;
+  void generate_gray_branch(GrayBranch& branch,
+                            int graph_index,
+                            int branch_index) const;
+};
+
+using GraphGenerator = BasicGraphGenerator<DefaultPolicy>;
+
+extern template class BasicGraphGenerator<DefaultPolicy>;
+extern template class BasicGraphGenerator<RuntimePolicy>;
+}  // namespace uni_cpp_practice
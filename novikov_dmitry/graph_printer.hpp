@@ -1,17 +1,22 @@
-#pragma once
-
-#include "graph.hpp"
-
-namespace uni_cpp_practice {
-
-class GraphPrinter {
- public:
-  explicit GraphPrinter(const Graph& graph) : graph_(graph){};
-
-  std::string print() const;
-
- private:
-  const Graph& graph_;
-};
-
-}  // namespace uni_cpp_practice
+#pragma once
+
+#include "graph.hpp"
+
+namespace uni_cpp_practice {
+
+class GraphPrinter {
+ public:
+  explicit GraphPrinter(const Graph& graph) : graph_(graph){};
+
+  std::string print() const;
+
+  // Записи одной вершины и одного ребра в формате print(), нужны
+  // для потоковой записи графа по частям
+  static std::string print_vertex(const Vertex& vertex);
+  static std::string print_edge(const Edge& edge);
+
+ private:
+  const Graph& graph_;
+};
+
+}  // namespace uni_cpp_practice
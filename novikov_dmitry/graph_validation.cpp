@@ -0,0 +1,187 @@
+#include "graph_validation.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using uni_cpp_practice::Depth;
+using uni_cpp_practice::Edge;
+using uni_cpp_practice::Graph;
+using uni_cpp_practice::Vertex;
+using uni_cpp_practice::VertexId;
+
+// Делит [0, size) на куски по числу ядер и проверяет их параллельно.
+// check(first_idx, last_idx) возвращает описание первого нарушения
+// в куске или пустую строку; результат - первое нарушение по порядку.
+template <typename Check>
+std::string check_in_parallel(int size, const Check& check) {
+  const int threads_count = std::max(
+      1, std::min<int>(std::thread::hardware_concurrency(), size));
+  std::vector<std::string> errors(threads_count);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threads_count; ++i) {
+    threads.emplace_back([&check, &errors, size, threads_count, i]() {
+      errors[i] = check(std::int64_t(size) * i / threads_count,
+                        std::int64_t(size) * (i + 1) / threads_count);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& error : errors) {
+    if (!error.empty()) {
+      return error;
+    }
+  }
+  return "";
+}
+
+bool check_color_depths(const Edge::Color& color,
+                        const Vertex& from_vertex,
+                        const Vertex& to_vertex) {
+  const Depth depth_difference = to_vertex.depth - from_vertex.depth;
+  switch (color) {
+    case Edge::Color::Gray:
+      return depth_difference == 1;
+    case Edge::Color::Green:
+      return from_vertex.id == to_vertex.id;
+    case Edge::Color::Blue:
+      return depth_difference == 0 && from_vertex.id != to_vertex.id;
+    case Edge::Color::Yellow:
+      return std::abs(depth_difference) == 1;
+    case Edge::Color::Red:
+      return std::abs(depth_difference) == 2;
+  }
+  return false;
+}
+
+std::string check_edge(const Graph& graph, const Edge& edge) {
+  const auto edge_name = "Edge " + std::to_string(edge.get_id());
+  const auto [from_vertex_id, to_vertex_id] = edge.get_binded_vertices();
+  if (!graph.has_vertex(from_vertex_id) || !graph.has_vertex(to_vertex_id)) {
+    return edge_name + ": vertex doesn't exist";
+  }
+  const auto& from_vertex = graph.get_vertex(from_vertex_id);
+  const auto& to_vertex = graph.get_vertex(to_vertex_id);
+  if (!from_vertex.has_edge_id(edge.get_id()) ||
+      !to_vertex.has_edge_id(edge.get_id())) {
+    return edge_name + ": not listed in its vertices";
+  }
+  if (!check_color_depths(edge.color, from_vertex, to_vertex)) {
+    return edge_name + ": " + color_to_string(edge.color) +
+           " doesn't match vertex depths";
+  }
+  return "";
+}
+
+std::string check_vertex(const Graph& graph,
+                         const VertexId& vertex_id,
+                         const Depth& depth) {
+  const auto vertex_name = "Vertex " + std::to_string(vertex_id);
+  if (!graph.has_vertex(vertex_id)) {
+    return vertex_name + ": listed at depth " + std::to_string(depth) +
+           " but doesn't exist";
+  }
+  const auto& vertex = graph.get_vertex(vertex_id);
+  if (vertex.depth != depth) {
+    return vertex_name + ": listed at depth " + std::to_string(depth) +
+           " but has depth " + std::to_string(vertex.depth);
+  }
+  int gray_parents_count = 0;
+  // Второй конец каждого ребра: совпадения - это повторные ребра
+  std::vector<VertexId> neighbor_ids;
+  neighbor_ids.reserve(vertex.get_neighbors().size());
+  for (const auto& neighbor : vertex.get_neighbors()) {
+    const auto edge_name = "edge " + std::to_string(neighbor.edge_id);
+    if (!graph.has_edge(neighbor.edge_id)) {
+      return vertex_name + ": " + edge_name + " doesn't exist";
+    }
+    const auto& edge = graph.get_edge(neighbor.edge_id);
+    const auto [from_vertex_id, to_vertex_id] = edge.get_binded_vertices();
+    if (from_vertex_id != vertex_id && to_vertex_id != vertex_id) {
+      return vertex_name + ": " + edge_name + " doesn't touch it";
+    }
+    // Запись соседа дублирует ребро и должна с ним совпадать
+    if (neighbor.vertex_id !=
+            (from_vertex_id == vertex_id ? to_vertex_id : from_vertex_id) ||
+        neighbor.color != edge.color) {
+      return vertex_name + ": " + edge_name + " is listed with wrong end";
+    }
+    if (edge.color == Edge::Color::Gray && to_vertex_id == vertex_id) {
+      ++gray_parents_count;
+    }
+    neighbor_ids.push_back(neighbor.vertex_id);
+  }
+  if (gray_parents_count != (depth == 0 ? 0 : 1)) {
+    return vertex_name + ": has " + std::to_string(gray_parents_count) +
+           " gray parents";
+  }
+  std::sort(neighbor_ids.begin(), neighbor_ids.end());
+  if (std::adjacent_find(neighbor_ids.begin(), neighbor_ids.end()) !=
+      neighbor_ids.end()) {
+    return vertex_name + ": has repeated edges";
+  }
+  return "";
+}
+
+}  // namespace
+
+namespace uni_cpp_practice {
+
+void validate(const Graph& graph) {
+  // Ребра лежат в векторе по id и делятся между потоками кусками
+  const auto& edge_map = graph.get_edge_map();
+  auto error = check_in_parallel(
+      edge_map.size(), [&graph, &edge_map](int first_idx, int last_idx) {
+        for (auto it = edge_map.begin() + first_idx;
+             it != edge_map.begin() + last_idx; ++it) {
+          if (it->first != it->second.get_id()) {
+            return "Edge " + std::to_string(it->first) + ": wrong id";
+          }
+          auto edge_error = check_edge(graph, it->second);
+          if (!edge_error.empty()) {
+            return edge_error;
+          }
+        }
+        return std::string();
+      });
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+
+  // Уровни делятся между потоками целиком
+  error = check_in_parallel(
+      graph.get_depth() + 1, [&graph](int first_depth, int last_depth) {
+        for (Depth depth = first_depth; depth < last_depth; ++depth) {
+          for (const auto& vertex_id : graph.get_vertices_at_depth(depth)) {
+            auto vertex_error = check_vertex(graph, vertex_id, depth);
+            if (!vertex_error.empty()) {
+              return vertex_error;
+            }
+          }
+        }
+        return std::string();
+      });
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+
+  int vertices_at_depths_count = 0;
+  for (Depth depth = 0; depth <= graph.get_depth(); ++depth) {
+    vertices_at_depths_count += graph.get_vertices_at_depth(depth).size();
+  }
+  if (vertices_at_depths_count != graph.get_vertex_map().size()) {
+    throw std::runtime_error("Vertices at depths don't match vertices count");
+  }
+  if (!graph.get_vertex_map().empty() &&
+      graph.get_vertices_at_depth(0).size() != 1) {
+    throw std::runtime_error("Depth 0 must have exactly one vertex");
+  }
+}
+
+}  // namespace uni_cpp_practice
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "graph.hpp"
+
+namespace uni_cpp_practice {
+
+// Проверяет инварианты готового графа: ребра ссылаются на существующие
+// вершины и записаны в обеих, цвет соответствует глубинам, у каждой
+// вершины кроме нулевой ровно один серый родитель уровнем выше, уровни
+// согласованы с глубинами вершин, нет повторных ребер.
+// Ребра и уровни проверяются параллельно. При первом найденном нарушении
+// бросает std::runtime_error с его описанием.
+void validate(const Graph& graph);
+
+}  // namespace uni_cpp_practice
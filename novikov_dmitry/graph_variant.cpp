@@ -0,0 +1,39 @@
+#include "graph_variant.hpp"
+
+namespace {
+using uni_cpp_practice::Edge;
+
+// Тот же порядок цветов, что и у generate
+constexpr std::array<Edge::Color, 4> OVERLAY_COLORS = {
+    Edge::Color::Green, Edge::Color::Yellow, Edge::Color::Red,
+    Edge::Color::Blue};
+}  // namespace
+
+namespace uni_cpp_practice {
+
+int GraphVariant::count_edges_of_color(const Edge::Color& color) const {
+  if (color == Edge::Color::Gray) {
+    return skeleton_->get_edge_map().size();
+  }
+  return get_edges(color).size();
+}
+
+int GraphVariant::count_edges() const {
+  int edges_count = 0;
+  for (int color = 0; color < COLORS_COUNT; ++color) {
+    edges_count += count_edges_of_color(Edge::Color(color));
+  }
+  return edges_count;
+}
+
+Graph GraphVariant::to_graph() const {
+  auto graph = *skeleton_;
+  for (const auto& color : OVERLAY_COLORS) {
+    for (const auto& [from_vertex_id, to_vertex_id] : get_edges(color)) {
+      graph.add_edge(from_vertex_id, to_vertex_id, color);
+    }
+  }
+  return graph;
+}
+
+}  // namespace uni_cpp_practice
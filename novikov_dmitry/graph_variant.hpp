@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "generation_policy.hpp"
+#include "graph.hpp"
+
+namespace uni_cpp_practice {
+
+// Вариант графа: серое дерево, общее для всех вариантов и неизменяемое,
+// и собственные цветные ребра варианта. N вариантов одного дерева
+// занимают одно дерево и N списков цветных ребер.
+class GraphVariant {
+ public:
+  using EdgeList = std::vector<std::pair<VertexId, VertexId>>;
+
+  explicit GraphVariant(std::shared_ptr<const Graph> skeleton)
+      : skeleton_(std::move(skeleton)) {}
+
+  const Graph& get_skeleton() const { return *skeleton_; }
+
+  // Ребра цвета color поверх дерева, для серого - пустой список
+  const EdgeList& get_edges(const Edge::Color& color) const {
+    return edges_of_color_[int(color)];
+  }
+
+  // edges - любой контейнер пар {from, to}
+  template <typename Edges>
+  void add_edges(const Edges& edges, const Edge::Color& color) {
+    auto& color_edges = edges_of_color_[int(color)];
+    color_edges.insert(color_edges.end(), edges.begin(), edges.end());
+  }
+
+  // Серые ребра считаются по дереву
+  int count_edges_of_color(const Edge::Color& color) const;
+  int count_edges() const;
+
+  // Обычный граф: копия дерева с ребрами варианта, добавленными
+  // в порядке green, yellow, red, blue. Проверки add_edge - по режиму
+  // дерева.
+  Graph to_graph() const;
+
+ private:
+  std::shared_ptr<const Graph> skeleton_;
+  std::array<EdgeList, COLORS_COUNT> edges_of_color_;
+};
+
+}  // namespace uni_cpp_practice
@@ -0,0 +1,349 @@
+#include "random_source.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RANDOM_SOURCE_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int PHILOX_ROUNDS = 10;
+constexpr std::uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85;
+// В слове счетчика проход занимает младшие 3 бита, scope - остальные
+constexpr int PASS_BITS = 3;
+// 24 старших бита дают равномерное float число в [0, 1)
+constexpr float UINT24_TO_FLOAT = 1.0f / (1 << 24);
+constexpr double UINT32_TO_DOUBLE = 1.0 / 4294967296.0;
+// Пропуск "до бесконечности", который ещё можно прибавить к индексу
+constexpr int MAX_GEOMETRIC_SKIP = std::numeric_limits<int>::max() / 2;
+
+using Block = std::array<std::uint32_t, 4>;
+using Key = std::array<std::uint32_t, 2>;
+
+void multiply_hi_lo(std::uint32_t a,
+                    std::uint32_t b,
+                    std::uint32_t& hi,
+                    std::uint32_t& lo) {
+  const std::uint64_t product = std::uint64_t(a) * b;
+  hi = product >> 32;
+  lo = product;
+}
+
+Block philox(Block counter, Key key) {
+  for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+    std::uint32_t hi0, lo0, hi1, lo1;
+    multiply_hi_lo(PHILOX_M0, counter[0], hi0, lo0);
+    multiply_hi_lo(PHILOX_M1, counter[2], hi1, lo1);
+    counter = {hi1 ^ counter[1] ^ key[0], lo1, hi0 ^ counter[3] ^ key[1], lo0};
+    key[0] += PHILOX_W0;
+    key[1] += PHILOX_W1;
+  }
+  return counter;
+}
+
+Key make_key(const uni_cpp_practice::RandomSource::Seed& seed) {
+  return {std::uint32_t(seed), std::uint32_t(seed >> 32)};
+}
+
+Block make_counter(const uni_cpp_practice::RandomSource::StreamKey& key) {
+  assert(int(key.pass) < (1 << PASS_BITS) && "pass doesn't fit key");
+  return {0, std::uint32_t(key.vertex_id),
+          (std::uint32_t(key.scope) << PASS_BITS) | std::uint32_t(key.pass),
+          std::uint32_t(key.graph_index)};
+}
+
+bool is_lucky_uint(std::uint32_t random_uint, float probability) {
+  return (random_uint >> 8) * UINT24_TO_FLOAT < probability;
+}
+
+void set_mask_bit(uni_cpp_practice::LuckyMask& lucky_mask, int idx) {
+  lucky_mask[idx / 64] |= std::uint64_t(1) << (idx % 64);
+}
+
+// Скалярная маска для вершин [first_idx, vertex_ids_count)
+void fill_lucky_mask_scalar(const Block& counter,
+                            const Key& key,
+                            const uni_cpp_practice::VertexId* vertex_ids,
+                            int first_idx,
+                            int vertex_ids_count,
+                            float probability,
+                            uni_cpp_practice::LuckyMask& lucky_mask) {
+  auto vertex_counter = counter;
+  for (int idx = first_idx; idx < vertex_ids_count; ++idx) {
+    vertex_counter[1] = std::uint32_t(vertex_ids[idx]);
+    if (is_lucky_uint(philox(vertex_counter, key)[0], probability)) {
+      set_mask_bit(lucky_mask, idx);
+    }
+  }
+}
+
+#ifdef RANDOM_SOURCE_X86
+constexpr int AVX2_LANES = 8;
+
+bool has_avx2() {
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+
+// Произведения 32x32 -> 64 для 8 лан: _mm256_mul_epu32 умножает только
+// четные ланы, поэтому нечетные сдвигаются на их место
+__attribute__((target("avx2"))) inline void multiply_hi_lo_avx2(
+    __m256i a,
+    __m256i b,
+    __m256i& hi,
+    __m256i& lo) {
+  const __m256i even = _mm256_mul_epu32(a, b);
+  const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+  lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0b10101010);
+  hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0b10101010);
+}
+
+// Тот же Philox, что и philox(), для 8 счетчиков {c0, c1[i], c2, c3[i]}.
+// Возвращает первые слова блоков.
+__attribute__((target("avx2"))) inline __m256i philox_avx2(
+    std::uint32_t c0_value,
+    __m256i c1,
+    std::uint32_t c2_value,
+    __m256i c3,
+    const Key& key) {
+  const __m256i m0 = _mm256_set1_epi32(PHILOX_M0);
+  const __m256i m1 = _mm256_set1_epi32(PHILOX_M1);
+  __m256i c0 = _mm256_set1_epi32(c0_value);
+  __m256i c2 = _mm256_set1_epi32(c2_value);
+  std::uint32_t key0 = key[0], key1 = key[1];
+  for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+    __m256i hi0, lo0, hi1, lo1;
+    multiply_hi_lo_avx2(c0, m0, hi0, lo0);
+    multiply_hi_lo_avx2(c2, m1, hi1, lo1);
+    c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(key0));
+    c1 = lo1;
+    c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(key1));
+    c3 = lo0;
+    key0 += PHILOX_W0;
+    key1 += PHILOX_W1;
+  }
+  return c0;
+}
+
+// Маска для 8 счетчиков за раз, различающихся только вершиной.
+// Возвращает число обработанных вершин (кратно 8).
+__attribute__((target("avx2"))) int fill_lucky_mask_avx2(
+    const Block& counter,
+    const Key& key,
+    const uni_cpp_practice::VertexId* vertex_ids,
+    int vertex_ids_count,
+    float probability,
+    uni_cpp_practice::LuckyMask& lucky_mask) {
+  const __m256 scale = _mm256_set1_ps(UINT24_TO_FLOAT);
+  const __m256 threshold = _mm256_set1_ps(probability);
+  const __m256i c3 = _mm256_set1_epi32(counter[3]);
+  int idx = 0;
+  for (; idx + AVX2_LANES <= vertex_ids_count; idx += AVX2_LANES) {
+    const __m256i c1 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(vertex_ids + idx));
+    const __m256i c0 = philox_avx2(counter[0], c1, counter[2], c3, key);
+    // Как в is_lucky: 24 старших бита точно переводятся в float,
+    // поэтому сравнение совпадает со скалярным
+    const __m256 u =
+        _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(c0, 8)), scale);
+    const int bits =
+        _mm256_movemask_ps(_mm256_cmp_ps(u, threshold, _CMP_LT_OQ));
+    lucky_mask[idx / 64] |= std::uint64_t(bits) << (idx % 64);
+  }
+  return idx;
+}
+
+// Первые числа 8 потоков за раз, различающихся вершиной и номером графа.
+// Возвращает число обработанных потоков (кратно 8).
+__attribute__((target("avx2"))) int fill_first_uints_avx2(
+    const Block& counter,
+    const Key& key,
+    const int* graph_indices,
+    const uni_cpp_practice::VertexId* vertex_ids,
+    int streams_count,
+    std::uint32_t* uints) {
+  int idx = 0;
+  for (; idx + AVX2_LANES <= streams_count; idx += AVX2_LANES) {
+    const __m256i c1 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(vertex_ids + idx));
+    const __m256i c3 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(graph_indices + idx));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(uints + idx),
+                        philox_avx2(counter[0], c1, counter[2], c3, key));
+  }
+  return idx;
+}
+#endif
+
+}  // namespace
+
+namespace uni_cpp_practice {
+
+BinomialDistribution::BinomialDistribution(int _trials, float _probability)
+    : trials(_trials), probability(_probability) {
+  assert(trials >= 0 && "trials count can't be negative");
+  assert(probability + std::numeric_limits<float>::epsilon() >= 0 &&
+         probability - std::numeric_limits<float>::epsilon() <= 1.0 &&
+         "given probability is incorrect");
+  if (trials == 0 || probability <= 0) {
+    return;
+  }
+  if (probability >= 1) {
+    mode = trials;
+    return;
+  }
+  mode = std::min(int((trials + 1) * double(probability)), trials);
+  // log(C(trials, mode) * p^mode * (1 - p)^(trials - mode)), без lgamma:
+  // она пишет в глобальный signgam и не потокобезопасна
+  double log_mode_probability =
+      mode * std::log(double(probability)) +
+      (trials - mode) * std::log1p(-double(probability));
+  for (int i = 1; i <= mode; ++i) {
+    log_mode_probability += std::log(double(trials - mode + i) / i);
+  }
+  mode_probability = std::exp(log_mode_probability);
+}
+
+RandomSource::RandomSource(const Seed& seed, const StreamKey& stream_key)
+    : key_(make_key(seed)), counter_(make_counter(stream_key)) {}
+
+std::uint32_t RandomSource::get_next_uint() {
+  if (block_position_ == int(block_.size())) {
+    block_ = philox(counter_, key_);
+    ++counter_[0];
+    block_position_ = 0;
+  }
+  return block_[block_position_++];
+}
+
+bool RandomSource::is_lucky(float probability) {
+  assert(probability + std::numeric_limits<float>::epsilon() >= 0 &&
+         probability - std::numeric_limits<float>::epsilon() <= 1.0 &&
+         "given probability is incorrect");
+  return is_lucky_uint(get_next_uint(), probability);
+}
+
+int RandomSource::get_random_number(int size) {
+  assert(size > 0 && "size must be positive");
+  return (std::uint64_t(get_next_uint()) * std::uint32_t(size)) >> 32;
+}
+
+int RandomSource::get_geometric_skip(float probability) {
+  assert(probability + std::numeric_limits<float>::epsilon() >= 0 &&
+         probability - std::numeric_limits<float>::epsilon() <= 1.0 &&
+         "given probability is incorrect");
+  if (probability >= 1) {
+    return 0;
+  }
+  if (probability <= 0) {
+    return MAX_GEOMETRIC_SKIP;
+  }
+  // Обратное преобразование: u равномерно на (0, 1]
+  const double u = (double(get_next_uint()) + 1) * UINT32_TO_DOUBLE;
+  const double skip = std::floor(std::log(u) / std::log1p(-probability));
+  return std::min(skip, double(MAX_GEOMETRIC_SKIP));
+}
+
+int RandomSource::get_binomial(const BinomialDistribution& distribution) {
+  // Вырожденное распределение не тратит выборку
+  if (distribution.mode_probability >= 1) {
+    return distribution.mode;
+  }
+  return uni_cpp_practice::get_binomial(distribution, get_next_uint());
+}
+
+int get_binomial(const BinomialDistribution& distribution,
+                 std::uint32_t random_uint) {
+  const int trials = distribution.trials;
+  const int mode = distribution.mode;
+  if (distribution.mode_probability >= 1) {
+    return mode;
+  }
+  const double odds = distribution.probability / (1 - distribution.probability);
+  // Вычитаем из u вероятности значений, удаляясь от моды в обе стороны,
+  // пока u не станет отрицательным
+  double u = random_uint * UINT32_TO_DOUBLE - distribution.mode_probability;
+  if (u < 0) {
+    return mode;
+  }
+  int upper = mode, lower = mode;
+  double upper_probability = distribution.mode_probability;
+  double lower_probability = distribution.mode_probability;
+  while (upper < trials || lower > 0) {
+    if (upper < trials) {
+      upper_probability *= double(trials - upper) / (upper + 1) * odds;
+      ++upper;
+      u -= upper_probability;
+      if (u < 0) {
+        return upper;
+      }
+    }
+    if (lower > 0) {
+      lower_probability *= double(lower) / (trials - lower + 1) / odds;
+      --lower;
+      u -= lower_probability;
+      if (u < 0) {
+        return lower;
+      }
+    }
+  }
+  // u остался неотрицательным только из-за ошибок округления
+  return mode;
+}
+
+void fill_lucky_mask(const RandomSource::Seed& seed,
+                     int graph_index,
+                     const Edge::Color& pass,
+                     VertexIdSpan vertex_ids,
+                     float probability,
+                     LuckyMask& lucky_mask) {
+  const int vertex_ids_count = vertex_ids.size();
+  lucky_mask.assign((vertex_ids_count + 63) / 64, 0);
+  const auto key = make_key(seed);
+  const auto counter = make_counter({graph_index, 0, pass});
+  int first_scalar_idx = 0;
+#ifdef RANDOM_SOURCE_X86
+  if (has_avx2()) {
+    first_scalar_idx =
+        fill_lucky_mask_avx2(counter, key, vertex_ids.data(), vertex_ids_count,
+                             probability, lucky_mask);
+  }
+#endif
+  fill_lucky_mask_scalar(counter, key, vertex_ids.data(), first_scalar_idx,
+                         vertex_ids_count, probability, lucky_mask);
+}
+
+void fill_first_uints(const RandomSource::Seed& seed,
+                      const Edge::Color& pass,
+                      const std::vector<int>& graph_indices,
+                      const std::vector<VertexId>& vertex_ids,
+                      std::vector<std::uint32_t>& uints) {
+  assert(graph_indices.size() == vertex_ids.size() &&
+         "every stream needs graph index and vertex id");
+  const int streams_count = vertex_ids.size();
+  uints.resize(streams_count);
+  const auto key = make_key(seed);
+  auto counter = make_counter({0, 0, pass});
+  int first_scalar_idx = 0;
+#ifdef RANDOM_SOURCE_X86
+  if (has_avx2()) {
+    first_scalar_idx =
+        fill_first_uints_avx2(counter, key, graph_indices.data(),
+                              vertex_ids.data(), streams_count, uints.data());
+  }
+#endif
+  for (int idx = first_scalar_idx; idx < streams_count; ++idx) {
+    counter[1] = std::uint32_t(vertex_ids[idx]);
+    counter[3] = std::uint32_t(graph_indices[idx]);
+    uints[idx] = philox(counter, key)[0];
+  }
+}
+
+}  // namespace uni_cpp_practice
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "graph.hpp"
+
+namespace uni_cpp_practice {
+
+// Параметры распределения Binomial(trials, probability), не зависящие от
+// выборки: мода и ее вероятность считаются один раз (например, на уровень
+// глубины), а не на каждую выборку.
+struct BinomialDistribution {
+  BinomialDistribution(int _trials, float _probability);
+
+  const int trials = 0;
+  const float probability = 0;
+  int mode = 0;
+  double mode_probability = 1;
+};
+
+// Счетчиковый (counter-based) источник случайных чисел на основе Philox4x32-10.
+// Каждая выборка - это функция от (seed, ключ потока, номер выборки), поэтому
+// результат не зависит ни от числа потоков, ни от порядка их выполнения.
+// Объект хранит только ключ и счетчик, создавать его можно на каждую вершину.
+class RandomSource {
+ public:
+  using Seed = std::uint64_t;
+
+  // Ключ потока: номер графа в пакете, вершина и проход генерации (цвет).
+  // scope разделяет вершины, у которых ещё нет глобального id
+  // (например, вершины ветви до её слияния с графом).
+  struct StreamKey {
+    int graph_index = 0;
+    VertexId vertex_id = 0;
+    Edge::Color pass = Edge::Color::Gray;
+    int scope = 0;
+  };
+
+  RandomSource(const Seed& seed, const StreamKey& stream_key);
+
+  bool is_lucky(float probability);
+
+  int get_random_number(int size);
+
+  // Число неудач до первого успеха в испытаниях Бернулли с вероятностью
+  // probability: позволяет перепрыгнуть сразу к следующему успеху
+  int get_geometric_skip(float probability);
+
+  // Число успехов в distribution.trials испытаниях по одному равномерному
+  // числу: обратное преобразование с поиском от моды, в среднем
+  // O(sqrt(trials * p * (1 - p))) шагов без новых выборок
+  int get_binomial(const BinomialDistribution& distribution);
+
+  std::uint32_t get_next_uint();
+
+ private:
+  using Block = std::array<std::uint32_t, 4>;
+
+  std::array<std::uint32_t, 2> key_;
+  Block counter_;
+  Block block_ = {};
+  int block_position_ = block_.size();
+};
+
+// Маска решений для вершин уровня: бит i отвечает i-й вершине
+using LuckyMask = std::pmr::vector<std::uint64_t>;
+
+// Разыгрывает is_lucky сразу для всех вершин уровня: бит i маски равен
+// первому is_lucky потока {graph_index, vertex_ids[i], pass}. На процессорах
+// с AVX2 Philox считается по 8 вершин за раз, иначе - по одной; результат
+// побитно совпадает со скалярным RandomSource.
+void fill_lucky_mask(const RandomSource::Seed& seed,
+                     int graph_index,
+                     const Edge::Color& pass,
+                     VertexIdSpan vertex_ids,
+                     float probability,
+                     LuckyMask& lucky_mask);
+
+// Первые числа потоков {graph_indices[i], vertex_ids[i], pass}: uints[i]
+// равен первому get_next_uint такого потока. Как и в fill_lucky_mask,
+// на AVX2 Philox считается по 8 потоков за раз, а потоки могут быть
+// из разных графов - так разыгрываются уровни пакета графов.
+void fill_first_uints(const RandomSource::Seed& seed,
+                      const Edge::Color& pass,
+                      const std::vector<int>& graph_indices,
+                      const std::vector<VertexId>& vertex_ids,
+                      std::vector<std::uint32_t>& uints);
+
+// RandomSource::get_binomial по уже разыгранному числу random_uint
+int get_binomial(const BinomialDistribution& distribution,
+                 std::uint32_t random_uint);
+
+}  // namespace uni_cpp_practice
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <memory_resource>
+#include <type_traits>
+
+namespace uni_cpp_practice {
+
+// Вектор с местом под InlineCapacity элементов внутри самого объекта:
+// пока элементов не больше, память не выделяется, и они лежат рядом
+// с владельцем. Дальше растет вдвое, как std::vector, в memory_resource,
+// переданном в push_back или reserve: его хранит владелец, а не каждый
+// вектор. Копия, как у std::pmr, выделяет память из ресурса
+// по умолчанию. Только для тривиальных T, элементы только добавляются.
+template <typename T, int InlineCapacity>
+class SmallVector {
+  static_assert(std::is_trivial_v<T>, "SmallVector keeps only trivial types");
+
+ public:
+  SmallVector() {}
+  SmallVector(const SmallVector& other) { copy_from(other); }
+  SmallVector(SmallVector&& other) noexcept { move_from(other); }
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      free_heap();
+      copy_from(other);
+    }
+    return *this;
+  }
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this != &other) {
+      free_heap();
+      move_from(other);
+    }
+    return *this;
+  }
+  ~SmallVector() { free_heap(); }
+
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool is_inline() const { return capacity_ == InlineCapacity; }
+
+  const T* begin() const { return get_data(); }
+  const T* end() const { return get_data() + size_; }
+  const T& operator[](int idx) const { return get_data()[idx]; }
+
+  void reserve(int capacity,
+               std::pmr::memory_resource* memory_resource =
+                   std::pmr::get_default_resource()) {
+    if (capacity > capacity_) {
+      grow(capacity, memory_resource);
+    }
+  }
+
+  void push_back(const T& value,
+                 std::pmr::memory_resource* memory_resource =
+                     std::pmr::get_default_resource()) {
+    if (size_ == capacity_) {
+      grow(2 * capacity_, memory_resource);
+    }
+    get_data()[size_++] = value;
+  }
+
+ private:
+  // Память вне объекта и ресурс, которому ее вернуть
+  struct HeapValues {
+    T* values;
+    std::pmr::memory_resource* memory_resource;
+  };
+
+  int size_ = 0;
+  int capacity_ = InlineCapacity;
+  union {
+    T inline_values_[InlineCapacity];
+    HeapValues heap_;
+  };
+
+  T* get_data() { return is_inline() ? inline_values_ : heap_.values; }
+  const T* get_data() const {
+    return is_inline() ? inline_values_ : heap_.values;
+  }
+
+  void grow(int capacity, std::pmr::memory_resource* memory_resource) {
+    T* values = static_cast<T*>(
+        memory_resource->allocate(capacity * sizeof(T), alignof(T)));
+    std::copy(begin(), end(), values);
+    free_heap();
+    heap_ = {values, memory_resource};
+    capacity_ = capacity;
+  }
+
+  void free_heap() {
+    if (!is_inline()) {
+      heap_.memory_resource->deallocate(heap_.values, capacity_ * sizeof(T),
+                                        alignof(T));
+    }
+  }
+
+  void copy_from(const SmallVector& other) {
+    size_ = other.size_;
+    // В куче емкость всегда больше встроенной, поэтому is_inline
+    // определяется по емкости
+    capacity_ = std::max(other.size_, InlineCapacity);
+    if (!is_inline()) {
+      auto* memory_resource = std::pmr::get_default_resource();
+      heap_ = {static_cast<T*>(memory_resource->allocate(
+                   capacity_ * sizeof(T), alignof(T))),
+               memory_resource};
+    }
+    std::copy(other.begin(), other.end(), get_data());
+  }
+
+  void move_from(SmallVector& other) {
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    if (is_inline()) {
+      std::copy(other.begin(), other.end(), inline_values_);
+    } else {
+      heap_ = other.heap_;
+      other.capacity_ = InlineCapacity;
+    }
+    other.size_ = 0;
+  }
+};
+
+}  // namespace uni_cpp_practice
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -29,11 +31,8 @@ void Vertex::add_edge_id(const EdgeId& _id) {
 }
 
 bool Graph::is_vertex_exist(const VertexId& vertex_id) const {
-  for (const auto& vertex : vertices_) {
-    if (vertex_id == vertex.get_id())
-      return true;
-  }
-  return false;
+  // vertex ids are their indices in vertices_
+  return vertex_id >= 0 && vertex_id < get_vertices_num();
 }
 
 bool Graph::is_connected(const VertexId& from_vertex_id,
@@ -74,7 +73,7 @@ void Graph::connect_vertices(const VertexId& from_vertex_id,
       }
       return min_depth;
     }();
-    vertices_[to_vertex_id].depth = minimum_depth + 1;
+    set_vertex_depth(to_vertex_id, minimum_depth + 1);
     depth_ = std::max(depth_, minimum_depth + 1);
   }
 
@@ -104,6 +103,18 @@ void Graph::connect_vertices(const VertexId& from_vertex_id,
     vertices_[to_vertex_id].add_edge_id(new_edge.id);
 }
 
+void Graph::set_vertex_depth(const VertexId& vertex_id, int depth) {
+  auto& old_level = depth_map_[vertices_[vertex_id].depth];
+  // a new vertex is the last one at its level, so search from the end
+  const auto it = std::find(old_level.rbegin(), old_level.rend(), vertex_id);
+  assert(it != old_level.rend());
+  old_level.erase(std::next(it).base());
+  if (static_cast<int>(depth_map_.size()) <= depth)
+    depth_map_.resize(depth + 1);
+  depth_map_[depth].push_back(vertex_id);
+  vertices_[vertex_id].depth = depth;
+}
+
 std::vector<EdgeId> Graph::get_edge_ids_with_color(
     const Edge::Color& color) const {
   std::vector<EdgeId> edge_ids;
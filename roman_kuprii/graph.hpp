@@ -45,7 +45,10 @@ struct Vertex {
 
 class Graph {
  public:
-  void add_vertex() { vertices_.emplace_back(get_next_vertex_id()); }
+  void add_vertex() {
+    const auto& new_vertex = vertices_.emplace_back(get_next_vertex_id());
+    depth_map_[new_vertex.depth].push_back(new_vertex.get_id());
+  }
 
   bool is_vertex_exist(const VertexId& vertex_id) const;
 
@@ -60,6 +63,11 @@ class Graph {
   const std::vector<Vertex>& get_vertices() const { return vertices_; }
 
   int get_depth() const { return depth_; }
+  // Ids of the vertices at the given depth, in the order of creation
+  const std::vector<VertexId>& get_vertices_at_depth(int depth) const {
+    assert(depth >= 0 && depth < static_cast<int>(depth_map_.size()));
+    return depth_map_[depth];
+  }
   int get_vertices_num() const { return vertices_.size(); }
   int get_edges_num() const { return edges_.size(); }
 
@@ -68,12 +76,16 @@ class Graph {
  private:
   std::vector<Vertex> vertices_;
   std::vector<Edge> edges_;
+  // depth_map_[depth] - ids of the vertices at this depth
+  std::vector<std::vector<VertexId>> depth_map_ = {{}};
   int depth_ = 0;
   VertexId vertex_id_counter_ = 0;
   EdgeId edge_id_counter_ = 0;
 
   VertexId get_next_vertex_id() { return vertex_id_counter_++; }
   VertexId get_next_edge_id() { return edge_id_counter_++; }
+
+  void set_vertex_depth(const VertexId& vertex_id, int depth);
 };
 
 }  // namespace uni_cpp_practice
@@ -6,18 +6,20 @@
 
 namespace {
 
+// one generator per thread, seeded only once
+std::mt19937& get_random_generator() {
+  thread_local std::mt19937 gen(std::random_device{}());
+  return gen;
+}
+
 double get_real_random_number() {
-  std::random_device rd;
-  std::mt19937 gen(rd());
   std::uniform_real_distribution<> dis(0, 1);
-  return dis(gen);
+  return dis(get_random_generator());
 }
 
 int get_int_random_number(int upper_bound) {
-  std::random_device rd;
-  std::mt19937 gen(rd());
   std::uniform_int_distribution<> dis(0, upper_bound);
-  return dis(gen);
+  return dis(get_random_generator());
 }
 
 constexpr double GREEN_TRASHOULD = 0.1;
@@ -35,31 +37,15 @@ using uni_cpp_practice::VertexId;
 void add_blue_edges(Graph& work_graph) {
   const int graph_depth = work_graph.get_depth();
   for (int current_depth = 1; current_depth <= graph_depth; current_depth++) {
-    vector<Vertex> uni_depth_vertices;
-    for (const auto& vertex : work_graph.get_vertices())
-      if (vertex.depth == current_depth)
-        uni_depth_vertices.emplace_back(vertex);
-
-    std::array<VertexId, 2> adjacent_vertices = {INVALID_ID, INVALID_ID};
-    for (const auto& vertex : uni_depth_vertices) {
-      if (adjacent_vertices[0] == INVALID_ID) {
-        adjacent_vertices[0] = vertex.get_id();
-      } else if (adjacent_vertices[1] == INVALID_ID) {
-        adjacent_vertices[1] = vertex.get_id();
-        if (!work_graph.is_connected(adjacent_vertices[0],
-                                     adjacent_vertices[1]))
-          if (get_real_random_number() < BLUE_TRASHOULD)
-            work_graph.connect_vertices(adjacent_vertices[0],
-                                        adjacent_vertices[1], false);
-      } else {
-        adjacent_vertices[0] = adjacent_vertices[1];
-        adjacent_vertices[1] = vertex.get_id();
-        if (!work_graph.is_connected(adjacent_vertices[0],
-                                     adjacent_vertices[1]))
-          if (get_real_random_number() < BLUE_TRASHOULD)
-            work_graph.connect_vertices(adjacent_vertices[0],
-                                        adjacent_vertices[1], false);
-      }
+    const auto& uni_depth_vertices_ids =
+        work_graph.get_vertices_at_depth(current_depth);
+    for (size_t idx = 1; idx < uni_depth_vertices_ids.size(); idx++) {
+      const VertexId& first_vertex_id = uni_depth_vertices_ids[idx - 1];
+      const VertexId& second_vertex_id = uni_depth_vertices_ids[idx];
+      if (!work_graph.is_connected(first_vertex_id, second_vertex_id))
+        if (get_real_random_number() < BLUE_TRASHOULD)
+          work_graph.connect_vertices(first_vertex_id, second_vertex_id,
+                                      false);
     }
   }
 }
@@ -72,22 +58,45 @@ void add_green_edges(Graph& work_graph) {
                                     start_vertex.get_id(), false);
 }
 
+// Uniformly random vertex at end_depth that is not connected to
+// start_vertex, or INVALID_ID if there is none. Instead of scanning the whole
+// level, random vertices of the level are drawn until an unconnected one
+// comes up: start_vertex is connected to few of them, so this takes
+// O(degree) on average.
+VertexId get_random_unconnected_vertex_id(const Graph& work_graph,
+                                          const Vertex& start_vertex,
+                                          int end_depth) {
+  const auto& end_vertices_ids = work_graph.get_vertices_at_depth(end_depth);
+  size_t connected_num = 0;
+  for (const auto& edge_id : start_vertex.get_edges_ids()) {
+    const auto& connected_vertices =
+        work_graph.get_edges()[edge_id].connected_vertices;
+    const VertexId other_vertex_id =
+        connected_vertices[0] == start_vertex.get_id() ? connected_vertices[1]
+                                                       : connected_vertices[0];
+    if (work_graph.get_vertices()[other_vertex_id].depth == end_depth)
+      connected_num++;
+  }
+  if (connected_num == end_vertices_ids.size())
+    return INVALID_ID;
+
+  while (true) {
+    const VertexId end_vertex_id = end_vertices_ids[get_int_random_number(
+        end_vertices_ids.size() - 1)];
+    if (!work_graph.is_connected(start_vertex.get_id(), end_vertex_id))
+      return end_vertex_id;
+  }
+}
+
 void add_red_edges(Graph& work_graph) {
   const int graph_depth = work_graph.get_depth();
   for (const auto& start_vertex : work_graph.get_vertices()) {
     if (get_real_random_number() < RED_TRASHOULD) {
       if (start_vertex.depth + 2 <= graph_depth) {
-        vector<VertexId> red_vertices_ids;
-        for (const auto& end_vertex : work_graph.get_vertices()) {
-          if (end_vertex.depth == start_vertex.depth + 2)
-            if (!work_graph.is_connected(start_vertex.get_id(),
-                                         end_vertex.get_id()))
-              red_vertices_ids.emplace_back(end_vertex.get_id());
-        }
-        if (red_vertices_ids.size() > 0) {
-          work_graph.connect_vertices(start_vertex.get_id(),
-                                      red_vertices_ids[get_int_random_number(
-                                          red_vertices_ids.size() - 1)],
+        const VertexId end_vertex_id = get_random_unconnected_vertex_id(
+            work_graph, start_vertex, start_vertex.depth + 2);
+        if (end_vertex_id != INVALID_ID) {
+          work_graph.connect_vertices(start_vertex.get_id(), end_vertex_id,
                                       false);
         }
       }
@@ -101,20 +110,14 @@ void add_yellow_edges(Graph& work_graph) {
     const double probability = static_cast<double>(start_vertex.depth) /
                                static_cast<double>(graph_depth);
     if (get_real_random_number() < probability) {
-      vector<VertexId> yellow_vertices_ids;
-      for (const auto& end_vertex : work_graph.get_vertices()) {
-        if (end_vertex.depth == start_vertex.depth + 1) {
-          if (!work_graph.is_connected(start_vertex.get_id(),
-                                       end_vertex.get_id()))
-            yellow_vertices_ids.push_back(end_vertex.get_id());
+      if (start_vertex.depth + 1 <= graph_depth) {
+        const VertexId end_vertex_id = get_random_unconnected_vertex_id(
+            work_graph, start_vertex, start_vertex.depth + 1);
+        if (end_vertex_id != INVALID_ID) {
+          work_graph.connect_vertices(start_vertex.get_id(), end_vertex_id,
+                                      false);
         }
       }
-      if (yellow_vertices_ids.size() > 0) {
-        work_graph.connect_vertices(start_vertex.get_id(),
-                                    yellow_vertices_ids[get_int_random_number(
-                                        yellow_vertices_ids.size() - 1)],
-                                    false);
-      }
     }
   }
 }
@@ -130,22 +133,24 @@ void generate_new_vertices(Graph& work_graph,
                            uni_cpp_practice::graph_generation::Params params) {
   int depth = params.depth;
   int new_vertices_num = params.new_vertices_num;
-  for (int current_depth = 0; current_depth <= depth; current_depth++) {
+  for (int current_depth = 0; current_depth <= work_graph.get_depth();
+       current_depth++) {
     const double probability =
         static_cast<double>(current_depth) / static_cast<double>(depth);
-    for (const auto& vertex : work_graph.get_vertices()) {
-      const VertexId vertex_id = vertex.get_id();
-      if (vertex.depth == current_depth)
-        for (int iter = 0; iter < new_vertices_num; iter++) {
-          if (get_real_random_number() > probability) {
-            work_graph.add_vertex();
-            work_graph.connect_vertices(
-                vertex_id,
-                work_graph.get_vertices()[work_graph.get_vertices_num() - 1]
-                    .get_id(),
-                true);
-          }
+    // new vertices go to the next level, so this one doesn't change, but
+    // depth_map_ may reallocate: the level is looked up by index every time
+    for (size_t idx = 0;
+         idx < work_graph.get_vertices_at_depth(current_depth).size();
+         idx++) {
+      const VertexId vertex_id =
+          work_graph.get_vertices_at_depth(current_depth)[idx];
+      for (int iter = 0; iter < new_vertices_num; iter++) {
+        if (get_real_random_number() > probability) {
+          work_graph.add_vertex();
+          work_graph.connect_vertices(vertex_id,
+                                      work_graph.get_vertices_num() - 1, true);
         }
+      }
     }
   }
 }
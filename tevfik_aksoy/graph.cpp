@@ -1,4 +1,5 @@
 #include "graph.hpp"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -12,6 +13,16 @@ bool is_depth_valid(
     return false;
   return true;
 }
+
+// Makes room for count more elements. Grows geometrically: a plain
+// reserve(size + count) per small group would reallocate on every group.
+template <typename T>
+void reserve_more(std::vector<T>& container, int count) {
+  const auto required_size = container.size() + count;
+  if (required_size > container.capacity()) {
+    container.reserve(std::max(required_size, 2 * container.capacity()));
+  }
+}
 }  // namespace
 
 namespace uni_cpp_practice {
@@ -40,12 +51,9 @@ std::string color_to_string(const Edge::Color& color) {
   }
 }
 
+// Ids are handed out in insertion order, so a vertex is stored at its id
 bool Graph::does_vertex_exist(const VertexId& id) const {
-  for (const auto& vertex : vertices_)
-    if (vertex.id == id) {
-      return true;
-    }
-  return false;
+  return id >= 0 && id < vertices_.size();
 }
 
 VertexId Graph::insert_vertex() {
@@ -83,11 +91,9 @@ Edge::Color Graph::calculate_color_for_edge(const Vertex& source,
 }
 
 Vertex& Graph::get_vertex(const VertexId& id) {
-  for (auto& vertex : vertices_) {
-    if (id == vertex.id)
-      return vertex;
-  }
-  throw std::runtime_error("Vertex not found!");
+  if (!does_vertex_exist(id))
+    throw std::runtime_error("Vertex not found!");
+  return vertices_[id];
 }
 
 void Graph::insert_edge(const VertexId& source_id,
@@ -119,6 +125,36 @@ void Graph::insert_edge(const VertexId& source_id,
   }
 }
 
+VertexId Graph::insert_children(const VertexId& parent_id, int count) {
+  assert(does_vertex_exist(parent_id) && "Parent vertex doesn't exist!");
+  assert(count >= 0 && "Children count can't be negative!");
+  const auto depth = vertices_[parent_id].depth + 1;
+  if (depth_map_.size() == depth) {
+    depth_map_.emplace_back();
+  }
+  auto& gray_edges = colored_edges_map_[Edge::Color::Gray];
+  reserve_more(vertices_, count);
+  reserve_more(edges_, count);
+  reserve_more(gray_edges, count);
+  reserve_more(depth_map_[depth], count);
+  auto& parent = vertices_[parent_id];
+  parent.reserve_edge_ids(parent.get_edge_ids().size() + count);
+
+  const VertexId first_child_id = vertex_id_counter_;
+  for (int i = 0; i < count; i++) {
+    const auto child_id = get_new_vertex_id();
+    const auto edge_id = get_new_edge_id();
+    auto& child = vertices_.emplace_back(child_id);
+    child.depth = depth;
+    child.add_edge_id(edge_id);
+    vertices_[parent_id].add_edge_id(edge_id);
+    edges_.emplace_back(parent_id, child_id, edge_id, Edge::Color::Gray);
+    gray_edges.push_back(edge_id);
+    depth_map_[depth].push_back(child_id);
+  }
+  return first_child_id;
+}
+
 bool Graph::are_vertices_connected(const VertexId& source,
                                    const VertexId& destination) const {
   assert(does_vertex_exist(source) && "Source vertex doesn't exist!");
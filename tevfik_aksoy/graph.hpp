@@ -17,6 +17,7 @@ struct Vertex {
   explicit Vertex(const VertexId& id) : id(id) {}
 
   void add_edge_id(const EdgeId& id);
+  void reserve_edge_ids(int count) { edge_ids_.reserve(count); }
   const std::vector<EdgeId>& get_edge_ids() const;
 
   bool has_edge_id(const EdgeId& edge_id, const std::vector<EdgeId>& edge_ids) {
@@ -54,6 +55,10 @@ class Graph {
  public:
   VertexId insert_vertex();
   void insert_edge(const VertexId& source_id, const VertexId& destination_id);
+  // Inserts count children of parent_id together with their gray edges,
+  // reserving storage once for the whole group. Children get consecutive ids,
+  // the id of the first one is returned.
+  VertexId insert_children(const VertexId& parent_id, int count);
 
   bool does_vertex_exist(const VertexId& id) const;
 
@@ -9,19 +9,28 @@ namespace {
 constexpr float GREEN_EDGE_PROBABILITY = 0.1;
 constexpr float BLUE_EDGE_PROBABILITY = 0.25;
 constexpr float RED_EDGE_PROBABILITY = 0.33;
+// One engine per thread, seeded once: draws don't hit random_device.
+std::mt19937& get_random_engine() {
+  thread_local std::mt19937 mt(std::random_device{}());
+  return mt;
+}
+
 float get_random_probability() {
-  std::random_device rd;
-  std::mt19937 mt(rd());
   std::uniform_real_distribution<float> probability(0.0, 1);
-  return probability(mt);
+  return probability(get_random_engine());
+}
+
+// Number of failed trials before the next success: lets sparse passes jump
+// straight to the next chosen vertex instead of rolling for every vertex.
+int get_geometric_skip(float probability) {
+  std::geometric_distribution<int> skip(probability);
+  return skip(get_random_engine());
 }
 
 VertexId get_random_vertex_id(const std::vector<VertexId>& vertices) {
-  std::random_device rd;
-  std::mt19937 mt(rd());
   std::uniform_int_distribution<int> random_vertex_distribution(
       0, vertices.size() - 1);
-  return vertices[random_vertex_distribution(mt)];
+  return vertices[random_vertex_distribution(get_random_engine())];
 }
 
 std::vector<VertexId> filter_connected_vertices(
@@ -44,13 +53,17 @@ void GraphGenerator::generate_vertices_and_gray_edges(Graph& graph) const {
   for (VertexDepth depth = 0; depth < params_.max_depth; depth++) {
     bool is_new_vertex_generated = false;
     const float probability = (float)depth / (float)params_.max_depth;
-    for (const auto& source : graph.get_vertices_in_depth(depth)) {
-      for (int j = 0; j < params_.new_vertices_num; j++) {
-        if (get_random_probability() > probability) {
-          is_new_vertex_generated = true;
-          const VertexId new_vertex = graph.insert_vertex();
-          graph.insert_edge(source, new_vertex);
-        }
+    // One draw per parent instead of new_vertices_num trials
+    std::binomial_distribution<int> children_count_distribution(
+        params_.new_vertices_num, 1 - probability);
+    // A copy is needed: inserting children may reallocate the depth map
+    const auto sources = graph.get_vertices_in_depth(depth);
+    for (const auto& source : sources) {
+      const int children_count =
+          children_count_distribution(get_random_engine());
+      if (children_count > 0) {
+        is_new_vertex_generated = true;
+        graph.insert_children(source, children_count);
       }
     }
     if (!is_new_vertex_generated)
@@ -64,22 +77,21 @@ void GraphGenerator::generate_vertices_and_gray_edges(Graph& graph) const {
 }
 
 void GraphGenerator::generate_green_edges(Graph& graph) const {
-  for (const auto& vertex : graph.get_vertices()) {
-    if (get_random_probability() < GREEN_EDGE_PROBABILITY) {
-      graph.insert_edge(vertex.id, vertex.id);
-    }
+  const int vertices_count = graph.get_vertices().size();
+  for (int i = get_geometric_skip(GREEN_EDGE_PROBABILITY); i < vertices_count;
+       i += 1 + get_geometric_skip(GREEN_EDGE_PROBABILITY)) {
+    const auto id = graph.get_vertices()[i].id;
+    graph.insert_edge(id, id);
   }
 }
 
 void GraphGenerator::generate_blue_edges(Graph& graph) const {
   for (int depth = 0; depth < graph.depth(); depth++) {
     const auto& vertices_in_depth = graph.get_vertices_in_depth(depth);
-    for (VertexId j = 0; j < vertices_in_depth.size() - 1; j++) {
-      const auto source = vertices_in_depth[j];
-      const auto destination = vertices_in_depth[j + 1];
-      if (get_random_probability() < BLUE_EDGE_PROBABILITY) {
-        graph.insert_edge(source, destination);
-      }
+    const int pairs_count = vertices_in_depth.size() - 1;
+    for (int j = get_geometric_skip(BLUE_EDGE_PROBABILITY); j < pairs_count;
+         j += 1 + get_geometric_skip(BLUE_EDGE_PROBABILITY)) {
+      graph.insert_edge(vertices_in_depth[j], vertices_in_depth[j + 1]);
     }
   }
 }
@@ -107,10 +119,10 @@ void GraphGenerator::generate_red_edges(Graph& graph) const {
   for (VertexDepth depth = 0; depth < graph.depth() - 1; depth++) {
     const auto& vertices = graph.get_vertices_in_depth(depth);
     const auto& vertices_next = graph.get_vertices_in_depth(depth + 2);
-    for (const auto& vertex : vertices) {
-      if (get_random_probability() < RED_EDGE_PROBABILITY) {
-        graph.insert_edge(vertex, get_random_vertex_id(vertices_next));
-      }
+    const int vertices_count = vertices.size();
+    for (int i = get_geometric_skip(RED_EDGE_PROBABILITY); i < vertices_count;
+         i += 1 + get_geometric_skip(RED_EDGE_PROBABILITY)) {
+      graph.insert_edge(vertices[i], get_random_vertex_id(vertices_next));
     }
   }
 }